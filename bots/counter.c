@@ -0,0 +1,42 @@
+/*
+ * Example bot plugin: plays whatever beats the opponent's most frequent move
+ * in the available history window, rock when there is no history yet.
+ *
+ *   make bots && ./bin/rps --bot ./bin/bots/counter.so
+ */
+
+#include "rps_bot.h"
+
+static void counter_choose_n(void * state, const rps_bot_history_t * history, uint32_t n, uint8_t * out)
+{
+    (void) state;
+
+    uint64_t seen[3] = { 0, 0, 0 };
+    for (uint32_t i = 0; i < history->count; i++)
+    {
+        seen[history->rounds[i].opponent]++;
+    }
+
+    uint8_t likely = RPS_BOT_MOVE_ROCK;
+    if (seen[RPS_BOT_MOVE_PAPER] > seen[likely])    likely = RPS_BOT_MOVE_PAPER;
+    if (seen[RPS_BOT_MOVE_SCISSORS] > seen[likely]) likely = RPS_BOT_MOVE_SCISSORS;
+
+    uint8_t move = history->count ? (uint8_t) ((likely + 1) % 3) : RPS_BOT_MOVE_ROCK;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        out[i] = move;
+    }
+}
+
+static const rps_bot_api_t counter_api = {
+    .abi_version = RPS_BOT_ABI_VERSION,
+    .name        = "counter",
+    .create      = 0,
+    .destroy     = 0,
+    .choose_n    = counter_choose_n,
+};
+
+const rps_bot_api_t * rps_bot_entry(void)
+{
+    return &counter_api;
+}
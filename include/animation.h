@@ -0,0 +1,24 @@
+#pragma once
+
+#include "common.h"
+#include "keys.h"
+#include "layout.h"
+
+/*
+ * Frame-paced terminal animation.
+ *
+ * Frames are driven by a timerfd armed on absolute CLOCK_MONOTONIC deadlines, so the
+ * pace never drifts with the time spent painting. When the process or the terminal
+ * falls behind, the frames that are already due are skipped instead of being queued;
+ * the last frame is always shown. The wait also polls the terminal input, so a key press ends the
+ * animation at once; a resize refreshes `layout` and carries on.
+ */
+
+#define ANIMATION_FPS       (30)
+
+/* Paints frame `frame` (0-based) of the running animation. */
+typedef void (animation_frame_fn)(copied uint32_t frame, borrowed void * context);
+
+// Plays `frames` frames at `fps` frames per second. Returns key_none once the last frame
+// is shown, or the key that interrupted the animation (the last frame is NOT shown then).
+copied key_t animation_play(borrowed terminal_t * term, borrowed layout_t * layout, copied uint32_t frames, copied uint32_t fps, borrowed animation_frame_fn * paint, borrowed void * context);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "common.h"
+#include "rng.h"
+
+/*
+ * EXP3 bandit steering a match towards a target player win rate.
+ *
+ * Each arm is a way for the computer to play, from yielding to ruthless. The reward of
+ * a round is the player's score when the player is behind the target, and one minus it
+ * when ahead, so the arms that pull the running win rate back to the target gain
+ * weight. Weights are kept as logarithms and renormalised against the largest one, and
+ * the smallest is floored, so the bandit keeps adapting when the player changes pace.
+ *
+ * The whole state fits in one cache line and a round costs O(arms).
+ */
+
+#define BANDIT_ARMS         (3)
+#define BANDIT_TARGET       (0.45f)     /* default player win rate, draws count half */
+#define BANDIT_EXPLORATION  (0.1f)      /* default share of uniform exploration */
+#define BANDIT_DECAY        (1.0f / 16) /* default weight of the newest round in the running rate */
+
+typedef struct {
+    copied f32     log_weights[BANDIT_ARMS];
+    copied f32     probabilities[BANDIT_ARMS];
+    copied f32     target;
+    copied f32     rate;                /* running player score, exponentially decayed */
+    copied f32     exploration;
+    copied f32     decay;
+    copied uint8_t arm;                 /* last arm picked */
+} __attribute__((aligned(64))) bandit_t;
+
+_Static_assert(sizeof(bandit_t) <= 64, "bandit_t must fit in one cache line");
+
+void bandit_init(borrowed bandit_t * bandit, copied f32 target);
+// Retunes a running bandit; what it has learnt so far is kept.
+void bandit_tune(borrowed bandit_t * bandit, copied f32 target, copied f32 exploration, copied f32 decay);
+
+// Draws the arm to play this round.
+copied uint8_t bandit_pick(borrowed bandit_t * bandit, borrowed rng_t * rng);
+
+// Scores the last picked arm with the player's result: 1 win, 0.5 draw, 0 loss.
+void bandit_update(borrowed bandit_t * bandit, copied f32 score);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "common.h"
+#include "game.h"
+#include "rps_bot.h"
+
+/* A bot plugin loaded from a shared object, see rps_bot.h for the ABI. */
+typedef struct {
+    owned    void                * handle;
+    borrowed const rps_bot_api_t * api;
+    owned    void                * state;
+} bot_t;
+
+// Loads the plugin at `path` and creates its match state.
+// On failure returns false and points `error` at a static description.
+copied bool bot_load(borrowed bot_t * bot, borrowed const char * path, copied uint64_t seed, borrowed const char ** error);
+void bot_unload(borrowed bot_t * bot);
+
+// Asks the bot for its next `n` moves, out-of-range moves are folded into [0, 3).
+void bot_choose_n(borrowed bot_t * bot, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out);
+copied move_t bot_choose(borrowed bot_t * bot, borrowed const history_t * history);
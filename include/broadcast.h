@@ -0,0 +1,57 @@
+#pragma once
+
+#include <poll.h>
+
+#include "common.h"
+#include "game.h"
+
+#define BROADCAST_QUEUE     (16)    /* frames a spectator may lag behind before it is dropped */
+#define BROADCAST_BACKLOG   (4096)  /* connections the kernel holds until accepted, capped at somaxconn */
+
+/*
+ * An immutable, reference-counted serialized round. It is built once per round and
+ * shared by every spectator queue; the last spectator to finish sending it frees it.
+ */
+typedef struct {
+    copied uint32_t refs;
+    copied uint32_t len;
+    copied char     data[];
+} frame_t;
+
+typedef struct {
+    copied int        fd;
+    copied uint32_t   head;                         /* index of the oldest queued frame */
+    copied uint32_t   count;                        /* queued frames */
+    copied uint32_t   offset;                       /* bytes of the head frame already sent */
+    borrowed frame_t * queue[BROADCAST_QUEUE];
+} spectator_t;
+
+typedef struct {
+    copied int             listen_fd;
+    owned  spectator_t   * spectators;
+    copied uint32_t        count;
+    copied uint32_t        capacity;
+    copied uint64_t        dropped;                 /* spectators dropped for being too slow */
+    owned  struct pollfd * fds;                     /* broadcast_wait()'s, grown as needed */
+    copied uint32_t        fds_capacity;
+} broadcast_t;
+
+typedef struct {
+    copied uint64_t round;
+    copied move_t   player;
+    copied move_t   computer;
+    copied result_t result;
+    copied int8_t   styles[moves_count];            /* rock, paper, scissors style of the player */
+} broadcast_round_t;
+
+// Listens for spectators on the Unix socket at `path`, replacing a stale socket file.
+copied bool broadcast_open(borrowed broadcast_t * broadcast, borrowed const char * path);
+void broadcast_close(borrowed broadcast_t * broadcast);
+
+// Serializes `round` once and queues it to every spectator, then sends as much as the sockets take.
+void broadcast_publish(borrowed broadcast_t * broadcast, borrowed const broadcast_round_t * round);
+
+// A terminal_wait_fn (context: the broadcast_t): polls `fds` for the caller and, while it
+// waits, accepts spectators and sends queued frames as soon as their sockets take them,
+// instead of only when the next round is published.
+copied int broadcast_wait(borrowed void * context, borrowed struct pollfd * fds, copied int count, copied int timeout_ms);
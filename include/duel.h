@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <sys/types.h>
+
+#include "common.h"
+
+/*
+ * Two local rps processes playing each other through a shared-memory segment.
+ *
+ * The first process to open a duel name creates the segment (side 0), the second joins
+ * it (side 1). Each direction is a single-producer / single-consumer byte ring; the
+ * producer's head doubles as the futex word the consumer sleeps on, so a move crosses
+ * processes with one store and one FUTEX_WAKE.
+ */
+
+#define DUEL_MAGIC      (0x4C455544u)   /* "DUEL" little-endian */
+#define DUEL_RING       (64)            /* power of two */
+#define DUEL_NAME_MAX   (64)
+#define CACHE_LINE      (64)
+
+/* Messages besides moves (0..2) */
+#define DUEL_AGAIN      (0xFE)
+#define DUEL_QUIT       (0xFF)
+
+typedef struct {
+    _Atomic uint32_t head;                  /* next slot the producer writes, futex word */
+    copied  uint8_t  pad0[CACHE_LINE - sizeof(uint32_t)];
+    _Atomic uint32_t tail;                  /* next slot the consumer reads */
+    copied  uint8_t  pad1[CACHE_LINE - sizeof(uint32_t)];
+    copied  uint8_t  slots[DUEL_RING];
+} duel_ring_t;
+
+typedef struct {
+    _Atomic uint32_t magic;                 /* set last by the creator */
+    _Atomic uint32_t joined;                /* futex word the creator waits on */
+    copied  pid_t    pids[2];
+    copied  uint8_t  pad[CACHE_LINE - 2 * sizeof(uint32_t) - 2 * sizeof(pid_t)];
+    copied  duel_ring_t rings[2];           /* rings[i] carries messages from side i */
+} duel_shm_t;
+
+typedef struct {
+    borrowed duel_shm_t * shm;
+    copied   uint8_t      side;
+    copied   char         name[DUEL_NAME_MAX];
+} duel_t;
+
+// Creates or joins the duel called `name`.
+copied bool duel_open(borrowed duel_t * duel, borrowed const char * name);
+
+// Blocks until both sides are present.
+copied bool duel_wait_peer(borrowed duel_t * duel);
+
+copied bool duel_send(borrowed duel_t * duel, copied uint8_t message);
+
+// Blocks for the peer's next message, DUEL_QUIT if the peer is gone.
+copied uint8_t duel_recv(borrowed duel_t * duel);
+// Same, but gives up with -1 after about `timeout_ms` without a message, so the caller
+// can look at its other inputs in between.
+copied int32_t duel_recv_timeout(borrowed duel_t * duel, copied int timeout_ms);
+
+void duel_close(borrowed duel_t * duel);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "common.h"
+#include "strategy.h"
+
+/*
+ * Long-run win, draw and loss rates of a matchup, for `rps evaluate`.
+ *
+ * When both sides have finite memory (the random opponent or a lookup table, against a
+ * random, reference or table player) the rates are computed exactly from the limit of
+ * their joint Markov chain (see markov.h), in milliseconds. Opponents that learn without
+ * bound (meta, adaptive) or are opaque (bot plugins) fall back to simulating `rounds`
+ * rounds, and the rates are printed with their 95% confidence interval.
+ */
+
+#define EVALUATE_ROUNDS     (10 * 1000 * 1000)
+
+typedef struct {
+    copied   strategy_spec_t opponent;
+    borrowed const char    * player;        /* "random" or a reference player, see table.h */
+    borrowed const char    * player_table;  /* a table written by `rps evolve`, played as the player */
+    copied   f64             noise;         /* share of the player's moves made at random */
+    copied   uint64_t        rounds;        /* for the simulation fallback */
+} evaluate_config_t;
+
+// Evaluates the matchup and prints the rates to stdout. Returns false, with the reason on
+// stderr, if either side cannot be loaded.
+copied bool evaluate(borrowed const evaluate_config_t * config);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common.h"
+
+/*
+ * Genetic evolution of lookup-table strategies (see table.h), for `rps evolve`.
+ *
+ * The population lives in one contiguous array of TABLE_SIZE-byte genomes. Each
+ * generation, every candidate plays a fixed pool of scripted reference players; the
+ * candidates are split into chunks that a thread pool pulls from a shared counter, and a
+ * worker plays all games of its chunk in lockstep, so every round is a few array
+ * passes ending in one judge_n() call. All candidates of a generation see the same
+ * reference noise, and the results do not depend on the thread count.
+ */
+
+#define EVOLVE_POPULATION   (256)
+#define EVOLVE_GENERATIONS  (100)
+#define EVOLVE_ROUNDS       (1000)      /* per game against each reference player */
+
+typedef struct {
+    copied   uint32_t     population;
+    copied   uint32_t     generations;
+    copied   uint32_t     rounds;
+    copied   uint32_t     threads;      /* 0 for one per online CPU */
+    copied   uint64_t     seed;
+    borrowed const char * out;          /* where the fittest table is saved */
+    copied   bool         perf_counters;    /* report hardware counters, see perf.h */
+} evolve_config_t;
+
+// Runs the evolution, printing progress to stdout, and saves the fittest table.
+copied bool evolve(borrowed const evolve_config_t * config);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "common.h"
+
+/*
+ * Streams the round log to a file descriptor as CSV or JSON Lines.
+ *
+ * Memory stays flat whatever the log size: records are read into one fixed buffer,
+ * rows are formatted by hand into another, and output leaves in large write()s.
+ */
+
+typedef enum {
+    export_csv,
+    export_jsonl,
+} export_format_t;
+
+// Parses "csv" or "jsonl". Returns false for anything else.
+copied bool export_format_parse(borrowed const char * name, borrowed export_format_t * format);
+
+// Writes every round in the log to `out`. Returns false (with a message on stderr) on failure.
+copied bool export_rounds(copied export_format_t format, copied int out);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "common.h"
+#include "rps_bot.h"
+
+#define moves_count     (3)
+
+typedef enum {
+    move_rock     = RPS_BOT_MOVE_ROCK,
+    move_paper    = RPS_BOT_MOVE_PAPER,
+    move_scissors = RPS_BOT_MOVE_SCISSORS,
+} move_t;
+
+typedef enum {
+    result_draw = 0,
+    result_win  = 1,
+    result_lose = 2,
+} result_t;
+
+/*
+ * A finished round from the computer's side. Layout-compatible with
+ * `rps_bot_round_t`, so the history is handed to bot plugins without copying.
+ */
+typedef struct {
+    copied uint8_t computer;
+    copied uint8_t player;
+} round_t;
+
+_Static_assert(sizeof(round_t) == sizeof(rps_bot_round_t), "round_t must match the bot ABI");
+
+/*
+ * Sliding window over the most recent rounds in one contiguous buffer.
+ * When full, the older half is dropped with a single memmove, so pushes are
+ * amortized O(1) and memory stays bounded for arbitrarily long matches.
+ */
+typedef struct {
+    owned  round_t * rounds;
+    copied uint32_t  count;
+    copied uint32_t  capacity;
+    copied uint64_t  total;
+} history_t;
+
+#define HISTORY_WINDOW  (1u << 16)
+
+copied result_t judge(copied move_t player, copied move_t computer);
+// judge() over whole arrays of moves, branch-free so the compiler vectorizes it.
+void judge_n(borrowed const uint8_t * player, borrowed const uint8_t * computer, copied uint32_t n, borrowed uint8_t * results);
+
+copied bool history_init(borrowed history_t * history, copied uint32_t capacity);
+void history_free(borrowed history_t * history);
+void history_push(borrowed history_t * history, copied move_t player, copied move_t computer);
+
+// The history window as seen by a bot plugin.
+copied rps_bot_history_t history_view(borrowed const history_t * history);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "common.h"
+#include "strategy.h"
+
+/*
+ * Serves the interactive game to many terminals from one process (`rps --host PATH`).
+ *
+ * Clients connect to a Unix socket with their terminal in raw mode, for instance
+ * `socat -,rawer UNIX-CONNECT:PATH`, and each gets a full session. One event loop per
+ * online CPU accepts connections and runs its sessions as coroutines: a session is the
+ * same blocking code as a local game, but whenever its terminal would wait (for a key,
+ * an animation frame or a full socket) it hands control back to the loop, which resumes
+ * it once epoll says so. Every session paints into its own output buffer, flushed just
+ * before it waits, so one screen update is one write.
+ *
+ * Hosted players are anonymous: their styles, stats and rating last for the connection
+ * only. Rounds still go to the round log.
+ */
+
+#define HOST_STACK      (256 * 1024)    /* bytes of coroutine stack per session */
+#define HOST_BUFFER     (16 * 1024)     /* bytes of buffered output per session */
+#define HOST_EVENTS     (64)            /* epoll events handled per wakeup */
+#define HOST_BACKLOG    (128)
+
+typedef struct {
+    borrowed const char    * path;      /* the Unix socket to listen on */
+    copied   strategy_spec_t opponent;  /* every session gets its own, seeded apart */
+    copied   uint32_t        threads;   /* 0 for one per online CPU */
+    copied   bool            instant;
+} host_config_t;
+
+// Listens on `config->path` and serves sessions until the process is killed.
+// Returns false, with the reason on stderr, if the host cannot start.
+copied bool host_serve(borrowed const host_config_t * config);
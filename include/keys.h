@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common.h"
+#include "terminal.h"
 
 #define ctrl_mask           (0x1000)
 #define alt_mask            (0x2000)
@@ -46,10 +47,10 @@ enum
     key_f12,
 };
 
-copied key_t keyboard_key_event();
-// NOTE: this function is NOT thread-safe, use it only in single-thread situation.
-borrowed const char * keyboard_key_event_name_map(copied const key_t key);
+// Reads one key from `term`, blocking for its first byte. The rest of an escape sequence
+// is waited for at most 100ms, so a lone ESC still comes through. Returns key_none when
+// the read fails or is interrupted by a signal.
+copied key_t keyboard_key_event(borrowed terminal_t * term);
 
-void keyboard_event_timeout_enable();
-void keyboard_event_timeout_disable();
-void keyboard_event_timeout_toggle();
+// Formats a readable name for `key` into `keyname` (64 bytes is plenty), returns it.
+borrowed const char * keyboard_key_event_name_map(copied const key_t key, borrowed char * keyname, copied size_t size);
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <signal.h>
+#include "common.h"
+#include "terminal.h"
+
+/*
+ * Screen layout engine.
+ *
+ * The screen is split into fixed regions whose geometry is computed from the terminal
+ * size (TIOCGWINSZ). Renderers never print at "wherever the cursor is": they mark a
+ * region dirty and the engine repaints it in place. On SIGWINCH only the regions whose
+ * geometry changed are cleared and repainted.
+ *
+ * Each layout belongs to one terminal; the SIGWINCH handler only bumps a process-wide
+ * counter, and every layout notices on its next refresh that it has to re-query its size.
+ */
+
+typedef enum {
+    region_header,
+    region_picker,
+    region_result,
+    region_status,
+    region_scoreboard,
+
+    region_count,
+} region_id_t;
+
+typedef struct {
+    copied uint16_t row;        /* 0-based screen row */
+    copied uint16_t col;        /* 0-based screen column */
+    copied uint16_t height;
+    copied uint16_t width;
+} region_t;
+
+/* Paints the content of region `id`; the engine has already cleared its rows. */
+typedef void (region_paint_fn)(borrowed void * context, copied region_id_t id, borrowed const region_t * region);
+
+typedef struct {
+    borrowed terminal_t      * term;
+    copied   uint16_t          rows;
+    copied   uint16_t          cols;
+    copied   region_t          regions[region_count];
+    copied   bool              dirty[region_count];
+    borrowed region_paint_fn * paint;
+    borrowed void            * context;
+    copied   sig_atomic_t      resizes;     /* SIGWINCH count at the last size query */
+} layout_t;
+
+// Queries the terminal size, installs the SIGWINCH handler and marks every region dirty.
+void layout_init(borrowed layout_t * layout, borrowed terminal_t * term, borrowed region_paint_fn * paint, borrowed void * context);
+
+borrowed const region_t * layout_region(borrowed const layout_t * layout, copied region_id_t id);
+
+void layout_invalidate(borrowed layout_t * layout, copied region_id_t id);
+
+// Repaints all dirty regions.
+void layout_render(borrowed layout_t * layout);
+
+// Handles a pending resize, if any: recomputes the layout and repaints what moved.
+// Cheap when nothing happened, call it whenever input is interrupted.
+copied bool layout_refresh(borrowed layout_t * layout);
+
+// Builds the cursor positioning sequence for the 0-based (row, col) into `buf`
+// (at least 16 bytes), returns its length.
+copied size_t layout_goto(borrowed char * buf, copied uint16_t row, copied uint16_t col);
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "common.h"
+
+/*
+ * Ratings of everyone in the round log (`rps ratings`).
+ *
+ * Every record is a game between the player and the opponent it names, so the log is
+ * replayed through `rating_update_batch()` one read buffer at a time, in the order the
+ * rounds were played, and the best players are listed from the rating table's
+ * order-statistics tree with their percentiles.
+ */
+
+#define LEADERBOARD_TOP     (10)
+
+// Rates every round in the log and prints the `top` best players. Returns false (with a
+// message on stderr) on failure.
+copied bool leaderboard_print(copied uint32_t top);
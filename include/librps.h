@@ -0,0 +1,72 @@
+#pragma once
+
+/*
+ * librps: the rps game engine as a library (`make lib` builds lib/librps.a and lib/librps.so).
+ *
+ * A match pits one of the computer opponents of `rps --opponent / --bot / --table`
+ * against moves supplied by the caller. All allocation happens in rps_match_create();
+ * playing rounds, judging and reading the tally never allocate, lock or make syscalls
+ * (bot plugins aside), so a service can keep many matches and feed them whole batches.
+ *
+ * Moves are encoded as 0 = rock, 1 = paper, 2 = scissors, the same as in rps_bot.h.
+ * Results are seen from the caller's side: 0 = draw, 1 = win, 2 = lose.
+ *
+ * A match is not thread-safe, but distinct matches may be played on distinct threads.
+ * This header is self-contained so it can be installed next to the library.
+ */
+
+#include <stdint.h>
+
+#define RPS_API_VERSION     (1u)
+
+#define RPS_MOVE_ROCK       (0)
+#define RPS_MOVE_PAPER      (1)
+#define RPS_MOVE_SCISSORS   (2)
+
+#define RPS_RESULT_DRAW     (0)
+#define RPS_RESULT_WIN      (1)
+#define RPS_RESULT_LOSE     (2)
+
+#if defined(__GNUC__)
+#define RPS_API             __attribute__((visibility("default")))
+#else
+#define RPS_API
+#endif
+
+typedef struct rps_match rps_match_t;
+
+/* The computer opponent: `bot_path` wins over `table_path`, which wins over `opponent`. */
+typedef struct {
+    const char * opponent;          /* built-in strategy, NULL for "random" */
+    const char * bot_path;          /* bot plugin, see rps_bot.h */
+    const char * table_path;        /* lookup table written by `rps evolve` */
+    uint64_t     seed;              /* same seed and moves, same match */
+    float        target_win_rate;   /* "adaptive" only, 0 for the default of 0.45 */
+} rps_match_config_t;
+
+/* Returns RPS_API_VERSION of the library actually loaded. */
+RPS_API uint32_t      rps_version(void);
+
+/*
+ * Creates a match. On failure returns NULL and, if `error` is not NULL, points it at a
+ * static description.
+ */
+RPS_API rps_match_t * rps_match_create(const rps_match_config_t * config, const char ** error);
+RPS_API void          rps_match_destroy(rps_match_t * match);
+
+/*
+ * Plays `n` rounds: the caller's moves are read from `player`, the opponent's are written
+ * to `computer` and the results to `results` (either may be NULL if not wanted, both hold
+ * `n` bytes otherwise). Returns how many rounds were played: fewer than `n` only if a
+ * move in `player` is out of range, which stops the batch at that round.
+ *
+ * The opponent sees the same history as in the game: adaptive strategies learn round by
+ * round, batch-capable ones (plugins, tables, random) commit the whole batch at once.
+ */
+RPS_API uint32_t      rps_match_play_n(rps_match_t * match, const uint8_t * player, uint32_t n, uint8_t * computer, uint8_t * results);
+
+/* Rounds played so far, and how many of them ended with each result (indexed by RPS_RESULT_*). */
+RPS_API uint64_t      rps_match_rounds(const rps_match_t * match, uint64_t tally[3]);
+
+/* Judges `n` rounds without any opponent: `results[i]` is the outcome of `a[i]` against `b[i]`. */
+RPS_API void          rps_judge_n(const uint8_t * a, const uint8_t * b, uint32_t n, uint8_t * results);
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "common.h"
+#include "table.h"
+
+/*
+ * Exact long-run rates of a match between two finite-memory players.
+ *
+ * Each side is a policy: a distribution over its next move in each of the TABLE_SIZE
+ * contexts of table.h (the last two rounds). The context of the match is then a Markov
+ * chain with TABLE_SIZE states, started from context 0 as a table is. Its transition
+ * matrix is kept sparse, at most 9 successors per state, in CSR form indexed by the
+ * destination so that one step of the distribution is one pass of row dot products.
+ *
+ * The limit is found by power iteration on the lazy chain (I + P) / 2: it has the same
+ * stationary distributions but is aperiodic, so a deterministic cycle (a table against
+ * a scripted player) converges to its time average instead of oscillating. The rates are
+ * the outcome probabilities of each context weighted by that limit.
+ */
+
+#define MARKOV_STATES       (TABLE_SIZE)
+#define MARKOV_EDGES        (MARKOV_STATES * TABLE_SYMBOLS)
+#define MARKOV_TOLERANCE    (1e-13)         /* L1 change of one step at convergence */
+#define MARKOV_ITERATIONS   (10 * 1000 * 1000)
+
+typedef struct {
+    copied f64 moves[MARKOV_STATES][3];     /* chance of each move_t in each context */
+} markov_policy_t;
+
+typedef struct {
+    copied f64      rates[3];               /* indexed by result_t, player's view */
+    copied uint32_t iterations;
+    copied f64      residual;               /* L1 change of the last step */
+} markov_result_t;
+
+void markov_policy_uniform(borrowed markov_policy_t * policy);
+// Always plays `moves[context]`, a lookup table or a reference player (see table.h).
+void markov_policy_table(borrowed markov_policy_t * policy, borrowed const uint8_t * moves);
+// Swaps the player and computer moves of every context, so that a table written for the
+// computer can play as the player.
+void markov_policy_mirror(borrowed markov_policy_t * policy);
+// Keeps `policy` with probability 1 - `noise` and plays uniformly at random otherwise.
+void markov_policy_noise(borrowed markov_policy_t * policy, copied f64 noise);
+
+// Solves the match of `player` against `computer`. Returns false if the chain has not
+// settled within MARKOV_ITERATIONS steps; `result` then holds the last estimate.
+copied bool markov_evaluate(borrowed const markov_policy_t * player, borrowed const markov_policy_t * computer, borrowed markov_result_t * result);
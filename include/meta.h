@@ -0,0 +1,56 @@
+#pragma once
+
+#include "common.h"
+#include "game.h"
+#include "rng.h"
+
+/*
+ * Iocaine Powder style meta-predictor.
+ *
+ * Base predictors guess the player's next move (context matching over player,
+ * computer and joint histories at several lengths, plus decayed frequencies).
+ * Each guess is expanded into six variants (3 rotations x "player plays it" /
+ * "player second-guesses us"), every variant is scored on each round as if it
+ * had been played, and the best scorer picks the move.
+ *
+ * Scores and candidate moves are kept struct-of-arrays and updated with vector
+ * instructions; all per-round work is O(variants), independent of history length.
+ */
+
+#define META_CONTEXT_LENGTHS    (6)     /* 1, 2, 3, 4, 6, 8 rounds */
+#define META_CONTEXT_SOURCES    (3)     /* player, computer, joint */
+#define META_CONTEXT_TABLES     (META_CONTEXT_LENGTHS * META_CONTEXT_SOURCES)
+#define META_CONTEXT_SLOTS      (1024)  /* per table, power of two */
+#define META_FREQUENCIES        (2)
+#define META_PREDICTORS         (META_CONTEXT_TABLES + META_FREQUENCIES)
+#define META_VARIANTS           (META_PREDICTORS * 6)
+#define META_LANES              (4)
+#define META_PADDED             (CEIL_DIV(META_VARIANTS, META_LANES) * META_LANES)
+
+typedef struct {
+    copied uint16_t tag;            /* 0 = empty */
+    copied uint8_t  player;         /* player move that followed the context */
+    copied uint8_t  computer;       /* computer move that followed the context */
+} meta_slot_t;
+
+typedef struct {
+    /* struct-of-arrays variant state, META_PADDED lanes each */
+    copied f32      scores[META_PADDED]     __attribute__((aligned(16)));
+    copied int32_t  moves[META_PADDED]      __attribute__((aligned(16)));
+
+    copied f32      decay;
+    copied f32      frequency[META_FREQUENCIES][2][moves_count];   /* [rate][player/computer][move] */
+
+    /* last 8 symbols of each source as a base-3 (base-9 for joint) number, newest lowest */
+    copied uint32_t recent[META_CONTEXT_SOURCES];
+    copied uint32_t keys[META_CONTEXT_TABLES];      /* hashes of the current contexts */
+    copied uint64_t rounds;
+
+    copied meta_slot_t contexts[META_CONTEXT_TABLES][META_CONTEXT_SLOTS];
+
+    copied rng_t    rng;                            /* tie-breaks when nobody is ahead */
+} meta_t;
+
+void meta_init(borrowed meta_t * meta, copied uint64_t seed);
+copied move_t meta_choose(borrowed meta_t * meta);
+void meta_observe(borrowed meta_t * meta, copied move_t player, copied move_t computer);
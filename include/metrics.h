@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdatomic.h>
+
+#include "common.h"
+#include "game.h"
+
+/*
+ * Live counters and gauges, served in the Prometheus text format (`rps --metrics WHERE`).
+ *
+ * Every thread that counts gets its own cache-line-aligned block of values, claimed on
+ * its first update and handed to the next new thread once it exits. Only the owner ever
+ * writes a block, so an update is a plain add to a line no other core writes (relaxed
+ * atomics, so a scrape running meanwhile reads whole values). A scrape sums the blocks;
+ * a gauge is a value that also goes down, and only its sum means anything.
+ *
+ * WHERE is a Unix socket path, or a port number to listen on 127.0.0.1. A client that
+ * sends an HTTP request (Prometheus, `curl --unix-socket`) gets an HTTP response, one
+ * that sends nothing gets the bare text, for instance `socat - UNIX-CONNECT:PATH`.
+ */
+
+#define METRICS_BACKLOG     (16)
+#define METRICS_REQUEST     (4096)      /* bytes of request read before answering anyway */
+#define METRICS_IDLE_MS     (250)       /* silence after which a client gets the bare text */
+#define METRICS_TEXT        (8192)
+
+typedef enum {
+    /* rounds by result_t, from the player's side */
+    metric_rounds_draw,
+    metric_rounds_win,
+    metric_rounds_lose,
+
+    /* keys decoded by keyboard_key_event() */
+    metric_keys_text,
+    metric_keys_editing,            /* enter, tab, backspace, escape */
+    metric_keys_control,
+    metric_keys_alt,
+    metric_keys_navigation,         /* arrows, home / end, page up / down, insert / delete */
+    metric_keys_function,
+    metric_keys_unknown,
+
+    metric_terminal_bytes,
+    metric_terminal_writes,
+    metric_sessions_started,
+    metric_sessions_active,         /* gauge */
+
+    metrics_count,
+} metric_t;
+
+_Static_assert(metric_rounds_win - metric_rounds_draw == result_win && metric_rounds_lose - metric_rounds_draw == result_lose, "metric_rounds_draw + result must count that result");
+
+typedef struct metrics_block {
+    _Atomic  int64_t                values[metrics_count];
+    _Atomic  bool                   used;
+    borrowed struct metrics_block * next;
+} __attribute__((aligned(64))) metrics_block_t;
+
+/* The calling thread's block, nil until its first update. */
+extern _Thread_local metrics_block_t * metrics_local;
+
+// Claims a block for the calling thread. Returns nil if out of memory; updates are then dropped.
+borrowed metrics_block_t * metrics_claim(void);
+
+// Adds `delta` to `metric` for the calling thread.
+static inline void metrics_add(copied metric_t metric, copied int64_t delta)
+{
+    borrowed metrics_block_t * block = metrics_local ? metrics_local : metrics_claim();
+    if (block)
+    {
+        copied int64_t value = atomic_load_explicit(&block->values[metric], memory_order_relaxed);
+        atomic_store_explicit(&block->values[metric], value + delta, memory_order_relaxed);
+    }
+}
+
+// Sums every block into `values` (metrics_count entries).
+void metrics_collect(borrowed int64_t * values);
+
+// Serves the metrics at `where` from a detached thread. Returns false, with the reason on
+// stderr, if it cannot listen.
+copied bool metrics_serve(borrowed const char * where);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <time.h>
+
+#include "common.h"
+
+/*
+ * The monotonic clock, for elapsed times and deadlines: it never jumps when the wall
+ * clock is set.
+ */
+
+#define NSEC_PER_SEC    (1000000000ull)
+#define NSEC_PER_MSEC   (1000000ull)
+
+static inline copied uint64_t monotonic_ns(void)
+{
+    copied struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return cast(ts.tv_sec, uint64_t) * NSEC_PER_SEC + cast(ts.tv_nsec, uint64_t);
+}
+
+static inline copied f64 monotonic_seconds(void)
+{
+    copied struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return cast(ts.tv_sec, f64) + cast(ts.tv_nsec, f64) * 1e-9;
+}
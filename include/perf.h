@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdio.h>
+#include "common.h"
+
+/*
+ * Hardware performance counters around a measured run (`--perf-counters`), read with
+ * perf_event_open(2): cycles, instructions, branch misses and cache misses, user space
+ * only so the default perf_event_paranoid level allows them.
+ *
+ * Counters are inherited by threads created after perf_counters_open(), so a worker
+ * pool started later is counted too. Each counter is opened on its own, and those the
+ * CPU, the hypervisor or the kernel refuse are simply missing from the report; when the
+ * PMU has to multiplex them, totals are scaled by the time each one actually ran.
+ */
+
+typedef enum {
+    perf_cycles,
+    perf_instructions,
+    perf_branch_misses,
+    perf_cache_misses,
+    perf_counter_count,
+} perf_counter_t;
+
+typedef struct {
+    copied int      fd[perf_counter_count];         /* -1 if unavailable */
+    copied uint64_t values[perf_counter_count];     /* scaled totals of the last run */
+    copied int      error[perf_counter_count];      /* why an unavailable one was refused */
+} perf_counters_t;
+
+// Opens whatever counters the system allows, returns false if there is none at all.
+copied bool perf_counters_open(borrowed perf_counters_t * perf);
+void perf_counters_close(borrowed perf_counters_t * perf);
+
+// Zeroes and starts the counters, stops them and reads the totals.
+void perf_counters_start(borrowed perf_counters_t * perf);
+void perf_counters_stop(borrowed perf_counters_t * perf);
+// Leaves work out of a run: nothing is counted from a pause until the next resume.
+void perf_counters_pause(borrowed perf_counters_t * perf);
+void perf_counters_resume(borrowed perf_counters_t * perf);
+
+// Prints the totals, IPC and the per-round rates in the style of the simulate report.
+void perf_counters_report(borrowed const perf_counters_t * perf, copied uint64_t rounds, borrowed FILE * out);
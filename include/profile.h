@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stddef.h>
+#include "common.h"
+
+#define PROFILE_MAGIC       (0x46505352u)   /* "RSPF" little-endian */
+#define PROFILE_VERSION     (3)
+#define PROFILE_ENV         "RPS_PROFILE"
+#define PROFILE_FILENAME    ".rps_profile"
+#define PROFILE_OPPONENTS   (16)
+#define PROFILE_PLAYER      "you"       /* the player's name in rating tables */
+
+/* An opponent's rating as the player's last session left it */
+typedef struct {
+    copied uint64_t id;                 /* rating_id() of its name, 0 for an empty entry */
+    copied f32      rating;
+    copied f32      deviation;
+    copied uint32_t games;
+    copied uint32_t reserved;
+} profile_opponent_t;
+
+/*
+ * On-disk profile, stored as-is (native endianness, fixed layout).
+ * Bump PROFILE_VERSION whenever the layout changes; unknown versions are ignored.
+ * Fields are only ever appended, so an older profile loads as a prefix of this one.
+ *
+ * It holds the player's styles, stats and ratings, not the opponents' models: the meta
+ * model alone is some 72 KiB of context tables, past what the 16-bit `size` describes,
+ * and a model is a match's, not the player's. A restarted session meets a cold opponent.
+ */
+typedef struct {
+    copied uint32_t magic;
+    copied uint16_t version;
+    copied uint16_t size;               /* sizeof(profile_t) at write time */
+
+    /* styles */
+    copied int8_t   rock_style;
+    copied int8_t   paper_style;
+    copied int8_t   scissor_style;
+    copied bool     styles_chosen;
+    copied uint32_t reserved;
+
+    /* cumulative stats */
+    copied uint64_t rounds;
+    copied uint64_t wins;
+    copied uint64_t losses;
+    copied uint64_t draws;
+
+    /* formerly per-move counts that no opponent ever read; kept zero for the layout */
+    copied uint8_t  unused[32];
+
+    /* version 2: the player's Glicko rating */
+    copied f32      rating;
+    copied f32      deviation;
+    copied uint64_t rated_games;
+
+    /* version 3: the ratings of the opponents the player met, so each session goes on from them */
+    copied profile_opponent_t opponents[PROFILE_OPPONENTS];
+} profile_t;
+
+/* Sizes of the older versions, each a prefix of the next */
+#define PROFILE_V1_SIZE     (offsetof(profile_t, rating))
+#define PROFILE_V2_SIZE     (offsetof(profile_t, opponents))
+
+// Resets `profile` to a fresh, valid profile.
+void profile_init(borrowed profile_t * profile);
+
+// Maps the profile file read-only and copies it into `profile`.
+// Returns false (and leaves a fresh profile) if it is missing or invalid.
+copied bool profile_load(borrowed profile_t * profile);
+
+// Writes the profile to a temporary file and atomically renames it into place.
+copied bool profile_save(borrowed const profile_t * profile);
+
+// The entry of opponent `id`, claimed at the initial rating if it has none yet. When all
+// are taken, the opponent met in the fewest games is forgotten.
+borrowed profile_opponent_t * profile_opponent(borrowed profile_t * profile, copied uint64_t id);
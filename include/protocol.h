@@ -0,0 +1,26 @@
+#pragma once
+
+#include "common.h"
+#include "strategy.h"
+
+/*
+ * Pipe protocol for scripted players (`rps --bot-protocol`).
+ *
+ * The client writes its moves as single bytes, `r`, `p`, `s` (or `0`, `1`, `2`, any
+ * case); rps answers each one with two bytes, the computer's move and the client's
+ * result (`w`, `l` or `d`). Newlines are echoed, so one line of moves gets one line of
+ * answers; blanks (space, tab, CR) are skipped and any other byte is answered with `?`.
+ *
+ *     client:  rps\n      rps:  plrwsd\n     (paper beats rock: loss, rock: win, ...)
+ *
+ * Moves can be pipelined freely: every read() of up to PROTOCOL_BUFFER bytes is played
+ * as a whole and answered with a single write(), never one round per syscall. Rounds
+ * are played against the opponent exactly as in a game; strategies that may commit
+ * moves in advance (see strategy_t.batch) get each read's moves as one batch.
+ * The player's profile, rating and round log are left alone.
+ */
+
+#define PROTOCOL_BUFFER     (64 * 1024)
+
+// Serves the protocol on `in` / `out` until `in` reaches end of file.
+copied bool protocol_serve(borrowed strategy_t * opponent, copied int in, copied int out);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stddef.h>
+#include "common.h"
+
+/*
+ * Glicko ratings for any number of players.
+ *
+ * Players live in a struct-of-arrays table (ids, ratings, deviations and game counts in
+ * separate contiguous arrays) so scans and batched updates stream through memory. An
+ * open-addressing index maps a player id to its slot. Updates keep a histogram of 1-point
+ * rating buckets current; the Fenwick tree answering percentile and top-K queries is
+ * rebuilt from it in O(buckets) on the first query after a batch, never per game.
+ */
+
+#define RATING_INITIAL      (1500.0f)
+#define RATING_DEVIATION    (350.0f)        /* initial and maximum deviation */
+#define RATING_BUCKETS      (4096)          /* ratings are clamped to [0, RATING_BUCKETS) */
+
+/* One finished game between two players. */
+typedef struct {
+    copied uint64_t player;
+    copied uint64_t opponent;
+    copied f32      score;                  /* player's view: 1 win, 0.5 draw, 0 loss */
+} rating_game_t;
+
+/* Index cell; the id is kept next to the slot so a lookup touches one cache line. */
+typedef struct {
+    copied uint64_t id;
+    copied uint32_t slot;                   /* slot + 1, 0 marks an empty cell */
+    copied uint32_t reserved;
+} rating_cell_t;
+
+typedef struct {
+    /* one entry per player, indexed by slot */
+    owned  uint64_t * ids;
+    owned  f32      * ratings;
+    owned  f32      * deviations;
+    owned  uint32_t * games;
+    copied uint32_t   count;
+    copied uint32_t   capacity;
+
+    /* id -> slot, power-of-two sized, linear probing */
+    owned  rating_cell_t * index;
+    copied uint32_t   index_mask;
+
+    /* players per rating bucket, and the Fenwick tree (1-based) built from it */
+    owned  uint32_t * counts;
+    owned  uint32_t * buckets;
+    copied bool       stale;                /* counts changed since the tree was built */
+} rating_table_t;
+
+copied bool rating_init(borrowed rating_table_t * table, copied uint32_t capacity);
+
+void rating_free(borrowed rating_table_t * table);
+
+// Stable id for a named player, e.g. a strategy or bot name.
+copied uint64_t rating_id(borrowed const char * name);
+
+// Returns the slot of `id`, or -1 if the player is unknown.
+copied int64_t rating_find(borrowed const rating_table_t * table, copied uint64_t id);
+
+// Returns the slot of `id`, adding the player with the given rating if unknown.
+// Returns -1 only when out of memory.
+copied int64_t rating_add(borrowed rating_table_t * table, copied uint64_t id, copied f32 rating, copied f32 deviation, copied uint32_t games);
+
+// Rates one game; unknown players join with the initial rating.
+copied bool rating_update(borrowed rating_table_t * table, borrowed const rating_game_t * game);
+
+// Rates `count` games in order. Slots are resolved for the whole batch first, so the
+// update pass only touches the player arrays.
+copied bool rating_update_batch(borrowed rating_table_t * table, borrowed const rating_game_t * games, copied size_t count);
+
+// Fraction of players rated strictly below `slot`, in [0, 1).
+copied f32 rating_percentile(borrowed rating_table_t * table, copied uint32_t slot);
+
+// Writes the slots of the `k` best players into `slots`, best first. Returns how many were written.
+copied uint32_t rating_top(borrowed rating_table_t * table, copied uint32_t k, borrowed uint32_t * slots);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/uio.h>
+#include "common.h"
+
+/*
+ * Session recorder writing asciicast v2 (https://docs.asciinema.org/manual/asciicast/v2/).
+ *
+ * The session thread only copies each terminal write, stamped with the monotonic clock,
+ * into a lock-free single-producer / single-consumer byte ring: no syscall, no lock,
+ * no formatting. A writer thread wakes every few milliseconds, turns whatever queued up
+ * into JSON event lines and writes them out in one go. If the writer ever falls a whole
+ * ring behind, new output is dropped and counted rather than stalling the game.
+ */
+
+#define RECORDER_RING       (1u << 20)      /* bytes, power of two */
+#define RECORDER_BATCH      (64 * 1024)     /* bytes of JSON per write() */
+
+typedef struct {
+    copied   int        fd;
+    copied   uint64_t   start_ns;
+
+    /* the ring: `head` is only written by the session thread, `tail` by the writer */
+    owned    uint8_t  * ring;
+    _Atomic  uint64_t   head;
+    _Atomic  uint64_t   tail;
+    _Atomic  bool       stop;
+    copied   uint64_t   dropped;            /* bytes the ring had no room for */
+
+    /* writer thread state */
+    copied   pthread_t  thread;
+    copied   bool       running;
+    owned    char     * batch;
+    copied   size_t     used;
+} recorder_t;
+
+// Creates `path` and writes the asciicast header, sized after the terminal on `out`.
+copied bool recorder_open(borrowed recorder_t * recorder, borrowed const char * path, copied int out);
+
+// Flushes what is still queued, stops the writer and closes the file.
+void recorder_close(borrowed recorder_t * recorder);
+
+// Queues one terminal write. Matches terminal_tap_fn, the context being the recorder.
+void recorder_capture(borrowed void * recorder, borrowed const struct iovec * iov, copied int count);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "common.h"
+
+/*
+ * PCG32 random number generator (O'Neill, pcg-random.org), XSH-RR variant.
+ *
+ * Every owner keeps its own generator, so independent sessions and strategies never
+ * share hidden state the way rand() does, and a seed replays a match exactly.
+ */
+
+/* Streams of the generators seeded from one session seed, so they never overlap */
+#define RNG_STREAM_RANDOM   (1)
+#define RNG_STREAM_META     (2)
+#define RNG_STREAM_PLAYER   (3)     /* the simulated player */
+#define RNG_STREAM_BANDIT   (4)
+#define RNG_STREAM_EVOLVE   (5)     /* initial population and breeding */
+#define RNG_STREAM_NOISE    (6)     /* reference players' random moves */
+#define RNG_STREAM_SHARD    (7)     /* simulated player of shard k: RNG_STREAM_SHARD + (k << 8) */
+#define RNG_STREAM_POPULATION (8)   /* the population opponent, until it has a prediction */
+
+typedef struct {
+    copied uint64_t state;
+    copied uint64_t inc;            /* stream selector, always odd */
+} rng_t;
+
+// Seeds `rng`; different `stream`s with the same seed give independent sequences.
+void rng_seed(borrowed rng_t * rng, copied uint64_t seed, copied uint64_t stream);
+
+copied uint32_t rng_next(borrowed rng_t * rng);
+
+// Uniform in [0, bound), without modulo bias.
+copied uint32_t rng_below(borrowed rng_t * rng, copied uint32_t bound);
+
+// Fills `out` with `n` uniform moves (0..2).
+void rng_moves(borrowed rng_t * rng, borrowed uint8_t * out, copied uint32_t n);
+
+// A seed from the clock and the process id, for when none is given.
+copied uint64_t rng_entropy();
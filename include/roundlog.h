@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stddef.h>
+#include "common.h"
+
+#define ROUNDLOG_MAGIC      "RPSROUND"
+#define ROUNDLOG_VERSION    (1)
+#define ROUNDLOG_ENV        "RPS_ROUNDS"
+#define ROUNDLOG_FILENAME   ".rps_rounds"
+#define ROUNDLOG_NAME_MAX   (16)
+
+/*
+ * Append-only log of every round played, one fixed-size record per round after a
+ * small header. Records go out with a single O_APPEND write(), so concurrent rps
+ * processes (e.g. both sides of a duel) can share one log without tearing records.
+ */
+typedef struct {
+    copied char     magic[8];
+    copied uint32_t version;
+    copied uint32_t record_size;        /* sizeof(roundlog_record_t) at write time */
+} roundlog_header_t;
+
+typedef struct {
+    copied uint64_t time_ns;                        /* CLOCK_REALTIME when the round was judged */
+    copied char     strategy[ROUNDLOG_NAME_MAX];    /* opponent name, NUL-padded, not terminated when full */
+    copied uint32_t round;                          /* 1-based within its session */
+    copied uint8_t  player;                         /* move_t */
+    copied uint8_t  computer;                       /* move_t */
+    copied uint8_t  result;                         /* result_t, player's view */
+    copied uint8_t  reserved;
+} roundlog_record_t;
+
+_Static_assert(sizeof(roundlog_record_t) == 32, "round log records are 32 bytes on disk");
+
+typedef struct {
+    copied int fd;
+} roundlog_t;
+
+// Resolves the log path: $RPS_ROUNDS, else $HOME/.rps_rounds.
+copied bool roundlog_path(borrowed char * buf, copied size_t size);
+
+// Opens the log for appending, creating it with its header if missing.
+copied bool roundlog_open(borrowed roundlog_t * log);
+
+// Appends one record. Failures are ignored, the log is best effort.
+void roundlog_append(borrowed roundlog_t * log, borrowed const roundlog_record_t * record);
+
+// Reads the header from `fd`, at the start of a log. Returns false unless it is a log
+// this build can read; the records follow.
+copied bool roundlog_read_header(copied int fd);
+
+void roundlog_close(borrowed roundlog_t * log);
@@ -1,29 +1,79 @@
 #pragma once
 
+#include <sys/uio.h>
+
 #include "common.h"
 
 #define rocks_count     (3)
 #define papers_count    (3)
 #define scissors_count  (2)
 
-copied const char * const rocks[rocks_count] = {
-    "✊",
-    "👊",
-    "🪨",
-};
+/*
+ * A printable asset with its byte length known at compile time and its display
+ * width (in terminal columns) measured once by `assets_measure()`, so renderers
+ * can place and repaint single cells without rescanning the UTF-8 bytes.
+ */
+typedef struct {
+    borrowed const char * bytes;
+    copied   uint8_t      byte_len;
+    copied   uint8_t      columns;
+} asset_t;
+
+#define ASSET(s)        { .bytes = (s), .byte_len = sizeof(s) - 1, .columns = 0 }
+
+/* View an asset as an iovec so whole lines go out in a single writev(). */
+#define IOV(asset)      ((struct iovec) { .iov_base = cast((asset).bytes, void *), .iov_len = (asset).byte_len })
+
+/* Fixed UI strings, styling already baked in. */
+typedef enum {
+    msg_banner,
+    msg_hint,
+    msg_styles_title,
+    msg_rock_style,
+    msg_paper_style,
+    msg_scissors_style,
+    msg_your_move,
+    msg_you,
+    msg_computer,
+    msg_opponent,
+    msg_waiting,
+    msg_opponent_left,
+    msg_shake_rock,
+    msg_shake_paper,
+    msg_shake_scissors,
+    msg_shake_shoot,
+    msg_rock,
+    msg_paper,
+    msg_scissors,
+    msg_win,
+    msg_lose,
+    msg_draw,
+    msg_play_again,
+    msg_yes,
+    msg_no,
+    msg_thanks,
+    msg_rounds,
+    msg_wins,
+    msg_losses,
+    msg_draws,
+    msg_rating,
+    msg_reversed,
+    msg_endcrayon,
+    msg_blank,
+    msg_crlf,
+
+    msg_count,
+} message_t;
 
-copied const char * papers[papers_count] = {
-    "✋",
-    "🫱",
-    "📜",
-};
+/* Defined in src/rps.c */
+extern asset_t rocks[rocks_count];
+extern asset_t papers[papers_count];
+extern asset_t scissors[scissors_count];
 
-copied const char * scissors[scissors_count] = {
-    "✌️",
-    "✂️",
-};
+extern asset_t trophy;
+extern asset_t attention;
+extern asset_t defeated;
 
-copied const char * trophy    = "🏆";
-copied const char * attention = "👀";
-copied const char * defeated  = "😵";
+extern asset_t messages[msg_count];
 
+void assets_measure();
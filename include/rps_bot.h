@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * rps bot plugin ABI.
+ *
+ * A bot is a shared object exporting `rps_bot_entry()`, which returns a pointer to a
+ * static `rps_bot_api_t`. It is loaded with `rps --bot path/to/bot.so` and replaces the
+ * built-in computer opponent.
+ *
+ * Moves are encoded as 0 = rock, 1 = paper, 2 = scissors.
+ *
+ * This header is self-contained so bot authors can copy it into their own tree.
+ */
+
+#include <stdint.h>
+
+#define RPS_BOT_ABI_VERSION     (1u)
+#define RPS_BOT_ENTRY_SYMBOL    "rps_bot_entry"
+
+#define RPS_BOT_MOVE_ROCK       (0)
+#define RPS_BOT_MOVE_PAPER      (1)
+#define RPS_BOT_MOVE_SCISSORS   (2)
+
+/* One finished round, seen from the bot's side. */
+typedef struct {
+    uint8_t bot;
+    uint8_t opponent;
+} rps_bot_round_t;
+
+/*
+ * A window over the most recent rounds, oldest first. `total` counts every round of the
+ * match, `count <= total` are still available in `rounds`. Only valid during the call.
+ */
+typedef struct {
+    const rps_bot_round_t * rounds;
+    uint32_t                count;
+    uint64_t                total;
+} rps_bot_history_t;
+
+typedef struct {
+    uint32_t     abi_version;   /* must be RPS_BOT_ABI_VERSION */
+    const char * name;
+
+    /* Creates per-match state; NULL fails the load. A stateless bot leaves it NULL. */
+    void * (*create)(uint64_t seed);
+    void   (*destroy)(void * state);
+
+    /*
+     * Commits the next `n` moves into `out` without seeing their outcomes.
+     * Interactive play calls it with n = 1; tournaments batch thousands of rounds
+     * per call, the history then only grows between calls.
+     */
+    void   (*choose_n)(void * state, const rps_bot_history_t * history, uint32_t n, uint8_t * out);
+} rps_bot_api_t;
+
+typedef const rps_bot_api_t * (*rps_bot_entry_fn)(void);
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <pthread.h>
+
+#include "common.h"
+#include "rps.h"
+#include "game.h"
+#include "sketch.h"
+#include "bot.h"
+#include "strategy.h"
+#include "broadcast.h"
+#include "duel.h"
+#include "profile.h"
+#include "rating.h"
+#include "roundlog.h"
+#include "recorder.h"
+#include "terminal.h"
+#include "layout.h"
+
+/*
+ * One game of rps: a player at a terminal against an opponent.
+ *
+ * Everything a match touches lives in the session, down to the opponent's random
+ * generator and the terminal it paints to, so any number of sessions can run in one
+ * process without locks as long as each one is driven by a single thread. The only
+ * shared data are the assets and messages, read-only once `assets_measure()` ran, and
+ * the SIGWINCH counter each layout polls.
+ */
+
+#define PICKER_LINES    (3)
+#define PICKER_ITEMS    (3)
+
+typedef enum {
+    outcome_hidden,
+    outcome_shake,
+    outcome_reveal,
+    outcome_shown,
+} outcome_phase_t;
+
+typedef struct {
+    /* where the player sits */
+    copied   terminal_t     terminal;
+    copied   layout_t       layout;
+
+    /* the player's chosen styles, cumulative stats and rating, persisted across runs */
+    copied   profile_t      profile;
+
+    /* rounds of the current match, the computer's strategy, and the plugin behind it if any */
+    copied   uint64_t         seed;
+    copied   history_t        history;
+    copied   sketch_context_t sketch;             /* the player's last moves, fed to the shared sketch */
+    copied   strategy_t       opponent;
+    copied   bot_t            bot;
+    copied   f32              target_win_rate;    /* for the "adaptive" opponent */
+
+    /* the worker that picks the computer's move while the player is still choosing, if started */
+    struct {
+        copied pthread_t       thread;
+        copied pthread_mutex_t lock;
+        copied pthread_cond_t  wake;
+        copied bool            running;
+        copied bool            pending;     /* a move was asked for and is not taken yet */
+        copied bool            ready;
+        copied bool            stop;
+        copied move_t          move;
+    } ahead;
+
+    /* the player's Glicko rating against this opponent */
+    copied   rating_table_t ratings;
+    copied   uint64_t       player_id;
+    copied   uint64_t       opponent_id;
+
+    /* every round played, the screen as recorded, spectators, and the other local player */
+    copied   roundlog_t     roundlog;
+    copied   recorder_t     recorder;
+    copied   broadcast_t    broadcast;
+    copied   duel_t         duel;
+
+    /*
+     * What each layout region shows. Input handlers only update these and invalidate
+     * the region; the paint callback turns them into output, so a resize can repaint
+     * any region at any time.
+     */
+    struct {
+        borrowed const asset_t * prompts[PICKER_LINES];
+        copied   asset_t         items[PICKER_LINES][PICKER_ITEMS];
+        copied   int8_t          counts[PICKER_LINES];
+        copied   int8_t          selected[PICKER_LINES];
+        copied   int8_t          lines;
+    } picker;
+
+    struct {
+        copied outcome_phase_t phase;
+        copied uint32_t        frame;       /* of the running animation */
+        copied move_t          player;
+        copied move_t          computer;
+        copied result_t        result;
+    } outcome;
+
+    struct {
+        borrowed const asset_t * message;
+        borrowed const asset_t * answer;
+    } status;
+
+    copied   bool           instant;        /* skip the countdown and reveal */
+    copied   bool           ephemeral;      /* hosted: the profile is neither loaded nor saved */
+    copied   bool           quit;           /* Ctrl-Q pressed or the input closed */
+} rps_session_t;
+
+// Prepares a session reading keys from `in` and painting to `out`; every generator of
+// the match derives from `seed`. Fails if out of memory.
+copied bool rps_session_init(borrowed rps_session_t * s, copied int in, copied int out, copied uint64_t seed);
+void rps_session_fin(borrowed rps_session_t * s);
+
+// Picks the computer: the bot plugin at `bot_path` or the evolved table at `table_path`
+// if given, else the built-in strategy `name`. On failure `*error` says why.
+copied bool rps_session_load_opponent(borrowed rps_session_t * s, borrowed const char * name, borrowed const char * bot_path, borrowed const char * table_path, borrowed const char ** error);
+
+// Chooses the computer's moves on a worker thread from now on, each one as soon as its
+// round starts, so the result can show the moment the player commits. Returns false if
+// the thread cannot be started; moves are then chosen inline as before.
+copied bool rps_session_think_ahead(borrowed rps_session_t * s);
+
+// Loads the profile and takes over the terminal. Call after the opponent and any duel
+// or broadcast are set up.
+copied bool rps_session_start(borrowed rps_session_t * s, copied bool choose_styles_again);
+// Gives the terminal back and says goodbye.
+void rps_session_stop(borrowed rps_session_t * s);
+
+void rps_session_choose_styles(borrowed rps_session_t * s);
+
+// Plays until the player is done: picks the styles if none were chosen yet, then rounds.
+void rps_session_run(borrowed rps_session_t * s);
+
+// Plays one round. Returns false if it could not be finished (quit, duel peer gone).
+copied bool rps_session_play_round(borrowed rps_session_t * s);
+// Asks for another round; in a duel both players must agree.
+copied bool rps_session_play_again(borrowed rps_session_t * s);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdatomic.h>
+#include "common.h"
+#include "game.h"
+#include "rng.h"
+#include "strategy.h"
+
+/*
+ * Sharded simulation (`rps --simulate ROUNDS --shards K`): K forked worker processes
+ * each play a random player with its own generator stream against their own copy of
+ * the opponent, so a crashing plugin takes down one shard, never the run.
+ *
+ * Workers report through one shared mapping, a cache-line-aligned slot each: after
+ * every batch a worker publishes its counters into one of two copies under the slot's
+ * sequence number, and the parent sums the slots for live progress, reading a copy
+ * again if it was overwritten meanwhile, without a single syscall on the workers' side.
+ * With `--checkpoint PATH` the mapping is that file, so the last published counters
+ * outlive any crash or interrupt; running the same command again resumes every shard
+ * where it stopped, its player generator included. Opponents cannot be saved and start
+ * over on resume, as after a reconnect.
+ */
+
+#define SHARD_MAX       (256)
+#define SHARD_MAGIC     (0x3244524148535052ull)     /* "RPSHARD2" */
+#define SHARD_REPORT_MS (250)                       /* progress refresh in the parent */
+
+typedef struct {
+    copied uint64_t done;               /* rounds played by the shard */
+    copied uint64_t tally[3];           /* indexed by result_t, player's view */
+    copied rng_t    player;             /* the simulated player's generator */
+} shard_progress_t;
+
+typedef enum {
+    shard_running,
+    shard_finished,
+    shard_failed,                       /* could not load its opponent */
+} shard_status_t;
+
+/* One worker's slot, a seqlock over two copies: see shard_publish_() in shard.c. */
+typedef struct {
+    _Atomic uint64_t         seq;
+    _Atomic uint32_t         status;
+    copied  shard_progress_t copy[2];
+} __attribute__((aligned(64))) shard_slot_t;
+
+/* The mapping: which run it belongs to, then the slots */
+typedef struct {
+    copied uint64_t magic;
+    copied uint64_t rounds;
+    copied uint64_t seed;
+    copied uint32_t shards;
+    copied uint32_t reserved;
+    copied char     opponent[96];
+} __attribute__((aligned(64))) shard_header_t;
+
+typedef struct {
+    copied   strategy_spec_t opponent;  /* its seed is the run's seed */
+    copied   uint64_t        rounds;
+    copied   uint32_t        shards;
+    borrowed const char    * checkpoint;    /* nil: nothing survives the run */
+} shard_config_t;
+
+// Runs the sharded simulation, printing progress to stderr and the tally to stdout.
+// Returns false if it could not run or a shard failed; a checkpointed run can then be resumed.
+copied bool shard_simulate(borrowed const shard_config_t * config);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "common.h"
+#include "strategy.h"
+
+#define SIMULATE_BATCH  (4096)
+#define SIMULATE_PLAYER "random player"     /* rating id of the simulated player */
+
+// Plays `rounds` rounds of a uniformly random player (seeded from `seed`) against
+// `opponent` and prints the tally and both players' ratings to stdout, and with
+// `perf_counters` what the CPU counted while the opponent chose and the rounds were
+// judged, without the random player and the rating pass (see perf.h).
+void simulate(borrowed strategy_t * opponent, copied uint64_t rounds, copied uint64_t seed, copied bool perf_counters);
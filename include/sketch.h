@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdatomic.h>
+
+#include "common.h"
+#include "game.h"
+
+/*
+ * Process-wide count-min sketch of the players' move n-grams: how often each move
+ * followed each run of a player's last 0..SKETCH_ORDER moves, summed over every player
+ * of every session; the empty run counts how often each move is played at all. Game and
+ * host sessions feed it next to their history, and so does the bot protocol when its
+ * opponent reads it; the "population" opponent only reads it, to predict a player it has
+ * never seen. Batch loops (simulate, shards, evaluate) and librps matches play synthetic
+ * or embedded players and leave it alone, so there "population" plays at random.
+ *
+ * The sketch is SKETCH_STRIPES sketches of identical shape; a thread adds only to its
+ * own stripe, so sessions on different cores never write the same cache line, and a
+ * query sums the stripes, which is itself a count-min sketch of the whole population.
+ * Counters are bumped with relaxed atomics. Each stripe halves its counters every
+ * SKETCH_DECAY_PERIOD updates, so the sketch follows the current population and its
+ * memory stays fixed (SKETCH_BYTES) whatever the number of players.
+ */
+
+#define SKETCH_ORDER        (4)         /* longest run of moves used as a context */
+#define SKETCH_ROWS         (4)         /* independent hashes, a query takes their minimum */
+#define SKETCH_WIDTH        (8192)      /* cells per row, power of two */
+#define SKETCH_STRIPES      (8)
+#define SKETCH_DECAY_PERIOD (1u << 16)  /* updates of a stripe between halvings */
+#define SKETCH_BYTES        (SKETCH_STRIPES * SKETCH_ROWS * SKETCH_WIDTH * sizeof(sketch_cell_t))
+
+/* The counts of the next move after one context; the padding keeps a cell in one line. */
+typedef struct {
+    _Atomic uint32_t counts[4];
+} sketch_cell_t;
+
+// The player's last moves, oldest first, as a session sees them.
+typedef struct {
+    copied uint8_t  moves[SKETCH_ORDER];
+    copied uint32_t count;              /* moves seen, capped at SKETCH_ORDER */
+} sketch_context_t;
+
+void sketch_context_init(borrowed sketch_context_t * context);
+
+// Appends `next` to `context` without counting it.
+void sketch_context_push(borrowed sketch_context_t * context, copied move_t next);
+
+// Counts `next` after every suffix of `context`, the empty one included, then appends it.
+// Returns false if the shared sketch could not be allocated; the context still advances.
+copied bool sketch_observe(borrowed sketch_context_t * context, copied move_t next);
+
+// Estimates how often each move followed the longest suffix of `context` seen at least
+// `confident` times in all, falling back to the empty suffix; returns that suffix length,
+// -1 if not even the empty one qualifies. Never allocates: before the first observation
+// anywhere it returns -1.
+copied int32_t sketch_predict(borrowed const sketch_context_t * context, copied uint32_t confident, borrowed uint64_t * counts);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "common.h"
+#include "game.h"
+#include "bot.h"
+
+/*
+ * The computer's move source. Built-in strategies are created by name, bot plugins
+ * are wrapped with `strategy_from_bot()`.
+ *
+ * `batch` is how many moves the strategy may commit per `choose_n()` call without
+ * seeing the outcomes in between: adaptive built-ins need 1, plugins take whole
+ * tournament batches.
+ *
+ * `reads_sketch` marks a strategy that predicts from the shared sketch (sketch.h) without
+ * feeding it; loops that only feed the sketch for a reader check it.
+ */
+typedef struct {
+    borrowed const char * name;
+    owned    void       * state;
+    copied   uint32_t     batch;
+    copied   bool         reads_sketch;
+
+    void (*choose_n)(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out);
+    void (*observe)(borrowed void * state, copied move_t player, copied move_t computer);
+    void (*destroy)(owned void * state);
+} strategy_t;
+
+#define STRATEGY_NAMES  "random, meta, adaptive, population"
+
+/* Where the computer's moves come from: a bot plugin, else a lookup table, else a built-in. */
+typedef struct {
+    borrowed const char * name;
+    borrowed const char * bot_path;
+    borrowed const char * table_path;
+    copied   uint64_t     seed;
+    copied   f32          target_win_rate;  /* "adaptive" only */
+} strategy_spec_t;
+
+// Creates the built-in strategy called `name` with its own generator seeded from `seed`,
+// returns false for unknown names.
+copied bool strategy_create(borrowed strategy_t * strategy, borrowed const char * name, copied uint64_t seed);
+// The "adaptive" strategy aiming for a player win rate of `target` (draws count half).
+copied bool strategy_create_adaptive(borrowed strategy_t * strategy, copied uint64_t seed, copied f32 target);
+// A lookup-table strategy playing `moves` (TABLE_SIZE entries, see table.h).
+copied bool strategy_create_table(borrowed strategy_t * strategy, borrowed const uint8_t * moves);
+void strategy_from_bot(borrowed strategy_t * strategy, borrowed bot_t * bot);
+// Creates the strategy described by `spec`, loading a plugin into `bot` if it names one.
+// On failure returns false and points `error` at a static description.
+copied bool strategy_load(borrowed strategy_t * strategy, borrowed bot_t * bot, borrowed const strategy_spec_t * spec, borrowed const char ** error);
+void strategy_destroy(borrowed strategy_t * strategy);
+
+copied move_t strategy_choose(borrowed strategy_t * strategy, borrowed const history_t * history);
+void strategy_choose_n(borrowed strategy_t * strategy, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out);
+void strategy_observe(borrowed strategy_t * strategy, copied move_t player, copied move_t computer);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "common.h"
+#include "game.h"
+
+/*
+ * Lookup-table strategy: the computer's move is read from a table indexed by the last
+ * two rounds (player and computer moves of each), 81 entries in all. Tables are what
+ * `rps evolve` breeds, and are saved as one line of digits 0 (rock), 1 (paper) and
+ * 2 (scissors), optionally preceded by `#` comment lines.
+ */
+
+#define TABLE_DEPTH     (2)             /* rounds of context */
+#define TABLE_SYMBOLS   (9)             /* joint outcomes of one round */
+#define TABLE_SIZE      (81)            /* TABLE_SYMBOLS ^ TABLE_DEPTH */
+#define TABLE_REFERENCES    (8)
+
+/* Scripted reference players, all functions of the last round from the player's side */
+typedef enum {
+    reference_rock,
+    reference_cycle,            /* rock, paper, scissors, ... */
+    reference_reverse_cycle,
+    reference_repeat,
+    reference_copy,             /* plays the computer's last move */
+    reference_beat_last,        /* plays what beats the computer's last move */
+    reference_win_stay,         /* keeps a winning move, moves on otherwise */
+    reference_lose_stay,        /* the other way round */
+} reference_t;
+
+#define TABLE_REFERENCE_NAMES   "rock, cycle, reverse-cycle, repeat, copy, beat-last, win-stay, lose-stay"
+
+typedef struct {
+    copied uint8_t moves[TABLE_SIZE];
+    copied uint8_t context;             /* last TABLE_DEPTH joint symbols, base 9, newest lowest */
+} table_t;
+
+/* The context after a round with `player` and `computer` moves. */
+#define TABLE_NEXT(context, player, computer) \
+        cast(((context) * TABLE_SYMBOLS + (player) * 3 + (computer)) % TABLE_SIZE, uint8_t)
+
+void table_init(borrowed table_t * table, borrowed const uint8_t * moves);
+copied move_t table_choose(borrowed const table_t * table);
+void table_observe(borrowed table_t * table, copied move_t player, copied move_t computer);
+
+// The player-side table of a reference player: `moves[context]` is the player's next move.
+void table_reference(copied reference_t reference, borrowed uint8_t * moves);
+// Parses one of TABLE_REFERENCE_NAMES. Returns false for anything else.
+copied bool table_reference_parse(borrowed const char * name, borrowed reference_t * reference);
+
+// Reads a table file. On failure `*error` says why.
+copied bool table_load(borrowed const char * path, borrowed uint8_t * moves, borrowed const char ** error);
+// Writes `moves` to `path` with `comment` as a header line (may be nil).
+copied bool table_save(borrowed const char * path, borrowed const uint8_t * moves, borrowed const char * comment);
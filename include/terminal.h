@@ -1,18 +1,78 @@
 #pragma once
 
 #include <unistd.h>
+#include <termios.h>
+#include <poll.h>
+#include <sys/uio.h>
 #include "common.h"
 
-void terminal_enter_raw_mode();
-void terminal_leave_raw_mode();
-void terminal_toggle_raw_mode();
+/* Sees every byte written to a terminal, e.g. to record the session. */
+typedef void (terminal_tap_fn)(borrowed void * context, borrowed const struct iovec * iov, copied int count);
 
-#define terminal_write(sequence, len) write(STDOUT_FILENO, sequence, len)
-void terminal_writef(borrowed const char * fmt, ...);
-void terminal_writef_owned(owned char * fmt, ...);
+/* Stands in for poll() whenever a terminal waits, e.g. to run other sessions meanwhile. */
+typedef int (terminal_wait_fn)(borrowed void * context, borrowed struct pollfd * fds, copied int count, copied int timeout_ms);
 
-void terminal_cursor_hide();
-void terminal_cursor_show();
-void terminal_flush();
+/*
+ * One terminal endpoint: where a session reads keys from and paints to.
+ * Every call takes the terminal explicitly, so any number of them can live in one
+ * process. Only the terminal that is raw on a real tty is restored by the SIGINT /
+ * SIGTERM handlers and at exit, signals being process-wide by nature.
+ */
+typedef struct {
+    copied   int                in;
+    copied   int                out;
+    copied   struct termios     original;     /* Original terminal attributes */
+    copied   bool               raw;          /* True if raw mode is active */
+    copied   bool               screen;       /* True if the alternate screen is active */
+    copied   bool               closed;       /* True once the input hit EOF or failed */
+    borrowed terminal_tap_fn  * tap;          /* nil unless someone listens to the output */
+    borrowed void             * tap_context;
+    borrowed terminal_wait_fn * wait;         /* nil to block in poll() */
+    borrowed void             * wait_context;
+    copied   bool               wait_first;   /* True if the input blocks, so reads wait through `wait` first */
+    owned    char             * buffer;       /* nil: every write goes straight out */
+    copied   size_t             used;
+    copied   size_t             capacity;
+} terminal_t;
 
-copied int32_t terminal_raw_byte_read();
+void terminal_init(borrowed terminal_t * term, copied int in, copied int out);
+// Flushes and frees the output buffer, if any.
+void terminal_fin(borrowed terminal_t * term);
+// Hands everything written to `term` from now on to `tap` as well (nil to stop).
+void terminal_tap(borrowed terminal_t * term, borrowed terminal_tap_fn * tap, borrowed void * context);
+// Makes `term` wait through `wait` rather than blocking (nil to block again). Its
+// descriptors may then be non-blocking; set that first, a blocking input is waited for
+// through `wait` before every read.
+void terminal_wait(borrowed terminal_t * term, borrowed terminal_wait_fn * wait, borrowed void * context);
+// Collects writes in a buffer of `capacity` bytes, sent whenever it fills or the
+// terminal is about to wait, so a whole screen update costs one syscall.
+copied bool terminal_buffer(borrowed terminal_t * term, copied size_t capacity);
+void terminal_flush(borrowed terminal_t * term);
+// poll() on behalf of `term`: buffered output goes out first, then `wait` is used if set.
+copied int terminal_poll(borrowed terminal_t * term, borrowed struct pollfd * fds, copied int count, copied int timeout_ms);
+
+// Puts `term` in raw mode. Fails if its input is a tty whose attributes cannot be read;
+// other inputs (pipes, sockets) are taken as already raw.
+copied bool terminal_enter_raw_mode(borrowed terminal_t * term);
+void terminal_leave_raw_mode(borrowed terminal_t * term);
+void terminal_toggle_raw_mode(borrowed terminal_t * term);
+
+// Switches to the alternate screen with autowrap off (overlong lines are clipped),
+// undone by terminal_screen_leave() or when raw mode is left.
+void terminal_screen_enter(borrowed terminal_t * term);
+void terminal_screen_leave(borrowed terminal_t * term);
+
+void terminal_write(borrowed terminal_t * term, borrowed const void * data, copied size_t len);
+void terminal_writev(borrowed terminal_t * term, borrowed const struct iovec * iov, copied int count);
+
+void terminal_cursor_hide(borrowed terminal_t * term);
+void terminal_cursor_show(borrowed terminal_t * term);
+void terminal_cursor_column(borrowed terminal_t * term, copied uint16_t col);
+// Builds the cursor-to-column sequence into `buf` (at least 16 bytes), returns its length.
+copied size_t terminal_cursor_column_sequence(borrowed char * buf, copied uint16_t col);
+
+// Reads one byte, blocking. Returns -1 on EOF, error or interruption by a signal;
+// the first two also mark the terminal closed.
+copied int32_t terminal_raw_byte_read(borrowed terminal_t * term);
+// Same, but gives up with -1 after `timeout_ms` without input.
+copied int32_t terminal_raw_byte_read_timeout(borrowed terminal_t * term, copied int timeout_ms);
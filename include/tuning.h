@@ -0,0 +1,45 @@
+#pragma once
+
+#include "common.h"
+
+/*
+ * Opponent tuning that can change while matches run (`rps --tuning PATH`).
+ *
+ * The file is watched with inotify; every save is parsed on the watcher thread into a
+ * fresh, immutable tuning_t, which is then published with one atomic pointer exchange.
+ * Readers bracket each round with tuning_lock() / tuning_unlock(), which never block
+ * or take a lock: they only announce the epoch they entered in, in a slot of their own.
+ * The old tuning is freed once every slot is quiet or has moved past the exchange, so a
+ * round sees one whole tuning from start to end and never a freed or half-written one.
+ * Until the first file is published readers just get the defaults, which are never
+ * freed: a process that watches no file (librps) never claims a slot or stores a thing.
+ *
+ * The file holds `key = value` lines and `#` comments; keys left out keep their
+ * defaults. A file that does not parse is reported on stderr and the tuning in force
+ * stays.
+ *
+ *     target_win_rate = 0.40      # adaptive, overrides --target-win-rate
+ *     exploration     = 0.1       # adaptive, share of uniform exploration
+ *     decay           = 0.0625    # adaptive, weight of the newest round in the running rate
+ */
+
+#define TUNING_LINE_MAX     (256)
+#define TUNING_GRACE_NS     (1000 * 1000)   /* between checks for readers still in an old epoch */
+
+typedef struct {
+    copied f32      target_win_rate;    /* 0 keeps each match's own target */
+    copied f32      exploration;
+    copied f32      decay;
+    copied uint64_t generation;         /* 0 for the defaults, then one more per reload */
+} tuning_t;
+
+// Parses a tuning file into `tuning`. On failure `*error` says why.
+copied bool tuning_load(borrowed const char * path, borrowed tuning_t * tuning, borrowed const char ** error);
+
+// Loads `path` and keeps reloading it whenever it changes, on a detached thread.
+// Returns false, with the reason on stderr, if the first load or the watch fails.
+copied bool tuning_watch(borrowed const char * path);
+
+// The tuning in force, valid until tuning_unlock(). Not reentrant: one section per thread.
+borrowed const tuning_t * tuning_lock(void);
+void tuning_unlock(void);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stddef.h>
+#include "common.h"
+
+#define UNICODE_REPLACEMENT (0xFFFD)
+
+/*
+ * Decodes one UTF-8 code point from `s` (at most `len` bytes).
+ * Stores the number of consumed bytes into `consumed` (always >= 1 when len > 0),
+ * malformed sequences decode to UNICODE_REPLACEMENT.
+ */
+copied uint32_t unicode_decode(borrowed const char * s, copied size_t len, borrowed size_t * consumed);
+
+/*
+ * Column width of a single code point: 0 (combining / joiner / selector),
+ * 1 (narrow) or 2 (wide / emoji presentation).
+ */
+copied uint8_t unicode_codepoint_width(copied uint32_t cp);
+
+/*
+ * Column width of a UTF-8 string, grapheme aware:
+ * - VS16 (U+FE0F) promotes the preceding narrow base to emoji presentation (2 columns)
+ * - ZWJ (U+200D) sequences collapse into the first glyph
+ * - skin tone modifiers and regional indicator pairs do not add columns
+ * - CSI escape sequences (colors, styles) are skipped
+ */
+copied uint16_t unicode_display_width(borrowed const char * s, copied size_t len);
@@ -0,0 +1,156 @@
+#include "animation.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/timerfd.h>
+
+#define NSEC_PER_SEC        (1000000000L)
+
+/* Bytes still waiting in the tty output queue above which a frame is dropped */
+#define OUTPUT_BACKLOG      (4096)
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied int  animation_timer_open_(copied uint32_t fps);
+static copied bool animation_terminal_behind_(borrowed const terminal_t * term);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied key_t animation_play(borrowed terminal_t * term, borrowed layout_t * layout, copied uint32_t frames, copied uint32_t fps, borrowed animation_frame_fn * paint, borrowed void * context)
+{
+    if (frames == 0)
+    {
+        return key_none;
+    }
+
+    copied int timer = animation_timer_open_(fps);
+    if (timer < 0 || frames == 1)
+    {
+        /* no timer, no animation: jump straight to the end */
+        if (timer >= 0)
+        {
+            close(timer);
+        }
+        paint(frames - 1, context);
+        return key_none;
+    }
+
+    copied uint32_t shown = 0;
+    paint(shown, context);
+
+    copied struct pollfd fds[2] = {
+        { .fd = timer,    .events = POLLIN },
+        { .fd = term->in, .events = POLLIN },
+    };
+
+    copied key_t key = key_none;
+    for (;;)
+    {
+        if (terminal_poll(term, fds, 2, -1) < 0)
+        {
+            if (errno != EINTR)
+            {
+                paint(frames - 1, context);
+                break;
+            }
+            /* most likely SIGWINCH */
+            layout_refresh(layout);
+            continue;
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            key = keyboard_key_event(term);
+            if (key != key_none)
+            {
+                break;
+            }
+        }
+
+        if (!(fds[0].revents & POLLIN))
+        {
+            continue;
+        }
+
+        /* the expiration count says how many deadlines passed since the last read */
+        copied uint64_t expirations = 0;
+        if (sizeof(expirations) != read(timer, &expirations, sizeof(expirations)))
+        {
+            continue;
+        }
+
+        copied uint64_t due = shown + expirations;
+        if (due >= frames - 1)
+        {
+            paint(frames - 1, context);
+            break;
+        }
+
+        shown = cast(due, uint32_t);
+        if (!animation_terminal_behind_(term))
+        {
+            paint(shown, context);
+        }
+    }
+
+    close(timer);
+    return key;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/* A periodic timer whose first deadline is one period from now, on the absolute clock. */
+static copied int animation_timer_open_(copied uint32_t fps)
+{
+    if (fps == 0)
+    {
+        return -1;
+    }
+
+    copied int timer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (timer < 0)
+    {
+        return -1;
+    }
+
+    copied struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    copied long period = NSEC_PER_SEC / cast(fps, long);
+    copied struct itimerspec spec = {
+        .it_interval = { .tv_sec = period / NSEC_PER_SEC, .tv_nsec = period % NSEC_PER_SEC },
+        .it_value    = { .tv_sec = now.tv_sec + period / NSEC_PER_SEC, .tv_nsec = now.tv_nsec + period % NSEC_PER_SEC },
+    };
+    if (spec.it_value.tv_nsec >= NSEC_PER_SEC)
+    {
+        spec.it_value.tv_sec  += 1;
+        spec.it_value.tv_nsec -= NSEC_PER_SEC;
+    }
+
+    if (timerfd_settime(timer, TFD_TIMER_ABSTIME, &spec, nil) < 0)
+    {
+        close(timer);
+        return -1;
+    }
+    return timer;
+}
+
+/* True while the terminal has not drained what we already wrote. */
+static copied bool animation_terminal_behind_(borrowed const terminal_t * term)
+{
+    copied int pending = 0;
+    if (ioctl(term->out, TIOCOUTQ, &pending) < 0)
+    {
+        return false;
+    }
+    return pending > OUTPUT_BACKLOG;
+}
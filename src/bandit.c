@@ -0,0 +1,98 @@
+#include "bandit.h"
+
+#include <math.h>
+
+#define BANDIT_LOG_FLOOR    (-8.0f)     /* no arm falls below e^-8 of the best one */
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void bandit_probabilities_(borrowed bandit_t * bandit);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void bandit_init(borrowed bandit_t * bandit, copied f32 target)
+{
+    for (uint8_t i = 0; i < BANDIT_ARMS; i++)
+    {
+        bandit->log_weights[i] = 0.0f;
+    }
+    bandit->target      = target;
+    bandit->rate        = target;
+    bandit->exploration = BANDIT_EXPLORATION;
+    bandit->decay       = BANDIT_DECAY;
+    bandit->arm         = 0;
+    bandit_probabilities_(bandit);
+}
+
+void bandit_tune(borrowed bandit_t * bandit, copied f32 target, copied f32 exploration, copied f32 decay)
+{
+    bandit->target      = target;
+    bandit->exploration = exploration;
+    bandit->decay       = decay;
+    bandit_probabilities_(bandit);
+}
+
+copied uint8_t bandit_pick(borrowed bandit_t * bandit, borrowed rng_t * rng)
+{
+    /* 24 random bits are all the resolution an f32 probability has */
+    copied f32 u = cast(rng_next(rng) >> 8, f32) * (1.0f / 16777216.0f);
+
+    copied uint8_t arm = BANDIT_ARMS - 1;
+    for (uint8_t i = 0; i < BANDIT_ARMS - 1; i++)
+    {
+        u -= bandit->probabilities[i];
+        if (u < 0.0f)
+        {
+            arm = i;
+            break;
+        }
+    }
+    bandit->arm = arm;
+    return arm;
+}
+
+void bandit_update(borrowed bandit_t * bandit, copied f32 score)
+{
+    copied f32 reward = (bandit->rate < bandit->target) ? score : 1.0f - score;
+    bandit->rate += bandit->decay * (score - bandit->rate);
+
+    /* importance-weighted estimate: only the played arm learns, scaled up by its odds */
+    copied uint8_t arm = bandit->arm;
+    bandit->log_weights[arm] += bandit->exploration * reward / (bandit->probabilities[arm] * BANDIT_ARMS);
+
+    copied f32 top = bandit->log_weights[0];
+    for (uint8_t i = 1; i < BANDIT_ARMS; i++)
+    {
+        top = fmaxf(top, bandit->log_weights[i]);
+    }
+    for (uint8_t i = 0; i < BANDIT_ARMS; i++)
+    {
+        bandit->log_weights[i] = fmaxf(bandit->log_weights[i] - top, BANDIT_LOG_FLOOR);
+    }
+
+    bandit_probabilities_(bandit);
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void bandit_probabilities_(borrowed bandit_t * bandit)
+{
+    copied f32 weights[BANDIT_ARMS];
+    copied f32 total = 0.0f;
+    for (uint8_t i = 0; i < BANDIT_ARMS; i++)
+    {
+        weights[i] = expf(bandit->log_weights[i]);
+        total     += weights[i];
+    }
+
+    for (uint8_t i = 0; i < BANDIT_ARMS; i++)
+    {
+        bandit->probabilities[i] = (1.0f - bandit->exploration) * weights[i] / total + bandit->exploration / BANDIT_ARMS;
+    }
+}
@@ -0,0 +1,90 @@
+#include "bot.h"
+
+#include <dlfcn.h>
+#include <string.h>
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Loading
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool bot_load(borrowed bot_t * bot, borrowed const char * path, copied uint64_t seed, borrowed const char ** error)
+{
+    memset(bot, 0, sizeof(*bot));
+
+    bot->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!bot->handle)
+    {
+        *error = dlerror();
+        return false;
+    }
+
+    /* POSIX-sanctioned way of turning a dlsym() result into a function pointer */
+    copied rps_bot_entry_fn entry = nil;
+    *(void **) (&entry) = dlsym(bot->handle, RPS_BOT_ENTRY_SYMBOL);
+    if (!entry)
+    {
+        *error = "missing " RPS_BOT_ENTRY_SYMBOL "()";
+        bot_unload(bot);
+        return false;
+    }
+
+    /* nothing of an api we cannot use may run, not even its destroy() */
+    borrowed const rps_bot_api_t * api = entry();
+    if (!api || api->abi_version != RPS_BOT_ABI_VERSION || !api->choose_n)
+    {
+        *error = "incompatible bot ABI version";
+        bot_unload(bot);
+        return false;
+    }
+
+    if (api->create)
+    {
+        bot->state = api->create(seed);
+        if (!bot->state)
+        {
+            *error = "the bot could not create its state";
+            bot_unload(bot);
+            return false;
+        }
+    }
+    bot->api = api;
+    return true;
+}
+
+void bot_unload(borrowed bot_t * bot)
+{
+    if (bot->api && bot->api->destroy)
+    {
+        bot->api->destroy(bot->state);
+    }
+    if (bot->handle)
+    {
+        dlclose(bot->handle);
+    }
+    memset(bot, 0, sizeof(*bot));
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Choosing
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void bot_choose_n(borrowed bot_t * bot, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out)
+{
+    copied rps_bot_history_t view = history_view(history);
+    bot->api->choose_n(bot->state, &view, n, out);
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (out[i] >= moves_count)
+        {
+            out[i] %= moves_count;
+        }
+    }
+}
+
+copied move_t bot_choose(borrowed bot_t * bot, borrowed const history_t * history)
+{
+    copied uint8_t move = 0;
+    bot_choose_n(bot, history, 1, &move);
+    return cast(move, move_t);
+}
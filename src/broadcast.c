@@ -0,0 +1,343 @@
+#include "broadcast.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#include "monotonic.h"
+
+#define BROADCAST_FRAME_MAX (128)
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void            broadcast_accept_(borrowed broadcast_t * broadcast);
+static void            broadcast_drop_(borrowed broadcast_t * broadcast, copied uint32_t idx);
+static copied bool     broadcast_flush_(borrowed spectator_t * spectator);
+static copied bool     broadcast_reserve_(borrowed broadcast_t * broadcast, copied uint32_t count);
+static owned frame_t * frame_serialize_(borrowed const broadcast_round_t * round);
+static void            frame_release_(owned frame_t * frame);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Lifecycle
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool broadcast_open(borrowed broadcast_t * broadcast, borrowed const char * path)
+{
+    memset(broadcast, 0, sizeof(*broadcast));
+    broadcast->listen_fd = -1;
+
+    copied struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        return false;
+    }
+    strcpy(addr.sun_path, path);
+
+    copied int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    unlink(path);
+    if (bind(fd, cast(&addr, struct sockaddr *), sizeof(addr)) < 0 || listen(fd, BROADCAST_BACKLOG) < 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    broadcast->listen_fd = fd;
+    return true;
+}
+
+void broadcast_close(borrowed broadcast_t * broadcast)
+{
+    while (broadcast->count > 0)
+    {
+        broadcast_drop_(broadcast, broadcast->count - 1);
+    }
+    free(broadcast->spectators);
+    free(broadcast->fds);
+
+    if (broadcast->listen_fd >= 0)
+    {
+        close(broadcast->listen_fd);
+    }
+
+    memset(broadcast, 0, sizeof(*broadcast));
+    broadcast->listen_fd = -1;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Publishing
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void broadcast_publish(borrowed broadcast_t * broadcast, borrowed const broadcast_round_t * round)
+{
+    if (broadcast->listen_fd < 0)
+    {
+        return;
+    }
+
+    broadcast_accept_(broadcast);
+    if (broadcast->count == 0)
+    {
+        return;
+    }
+
+    owned frame_t * frame = frame_serialize_(round);
+    if (!frame)
+    {
+        return;
+    }
+
+    /* one reference held by the publisher until every queue has its own */
+    frame->refs = 1;
+    for (uint32_t i = 0; i < broadcast->count; )
+    {
+        borrowed spectator_t * spectator = &broadcast->spectators[i];
+        if (spectator->count == BROADCAST_QUEUE)
+        {
+            broadcast->dropped++;
+            broadcast_drop_(broadcast, i);
+            continue;
+        }
+
+        spectator->queue[(spectator->head + spectator->count) % BROADCAST_QUEUE] = frame;
+        spectator->count++;
+        frame->refs++;
+
+        if (!broadcast_flush_(spectator))
+        {
+            broadcast_drop_(broadcast, i);
+            continue;
+        }
+        i++;
+    }
+    frame_release_(frame);
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Waiting
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied int broadcast_wait(borrowed void * context, borrowed struct pollfd * fds, copied int count, copied int timeout_ms)
+{
+    borrowed broadcast_t * broadcast = context;
+    copied   uint64_t      deadline  = (timeout_ms > 0) ? monotonic_ns() + cast(timeout_ms, uint64_t) * NSEC_PER_MSEC : 0;
+    for (;;)
+    {
+        if (broadcast->listen_fd < 0 || !broadcast_reserve_(broadcast, cast(count, uint32_t) + 1 + broadcast->count))
+        {
+            return poll(fds, cast(count, nfds_t), timeout_ms);
+        }
+
+        /* the caller's descriptors, the listener, then the spectators with frames to send, last first */
+        memcpy(broadcast->fds, fds, sizeof(struct pollfd) * cast(count, size_t));
+        copied nfds_t used = cast(count, nfds_t);
+        broadcast->fds[used++] = (struct pollfd) { .fd = broadcast->listen_fd, .events = POLLIN };
+        for (uint32_t i = broadcast->count; i-- > 0; )
+        {
+            if (broadcast->spectators[i].count > 0)
+            {
+                broadcast->fds[used++] = (struct pollfd) { .fd = broadcast->spectators[i].fd, .events = POLLOUT };
+            }
+        }
+
+        copied int left = timeout_ms;
+        if (deadline)
+        {
+            copied uint64_t now = monotonic_ns();
+            left = (now < deadline) ? cast(CEIL_DIV(deadline - now, NSEC_PER_MSEC), int) : 0;
+        }
+        copied int ready = poll(broadcast->fds, used, left);
+        if (ready < 0)
+        {
+            return -1;
+        }
+
+        /*
+         * Spectators were listed from the last one down, so dropping one only moves a
+         * spectator that was already served into its place.
+         */
+        copied nfds_t at = cast(count, nfds_t) + 1;
+        for (uint32_t i = broadcast->count; i-- > 0; )
+        {
+            if (broadcast->spectators[i].count == 0)
+            {
+                continue;
+            }
+            if (broadcast->fds[at++].revents && !broadcast_flush_(&broadcast->spectators[i]))
+            {
+                broadcast_drop_(broadcast, i);
+            }
+        }
+        if (broadcast->fds[count].revents)
+        {
+            broadcast_accept_(broadcast);
+        }
+
+        copied int mine = 0;
+        for (int i = 0; i < count; i++)
+        {
+            fds[i].revents = broadcast->fds[i].revents;
+            mine += (fds[i].revents != 0);
+        }
+        if (mine > 0 || ready == 0 || timeout_ms == 0)
+        {
+            return mine;
+        }
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Spectators
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void broadcast_accept_(borrowed broadcast_t * broadcast)
+{
+    for (;;)
+    {
+        copied int fd = accept(broadcast->listen_fd, nil, nil);
+        if (fd < 0)
+        {
+            return;     /* EAGAIN: nobody else is waiting */
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+        if (broadcast->count == broadcast->capacity)
+        {
+            copied uint32_t capacity = broadcast->capacity ? broadcast->capacity * 2 : 16;
+            owned spectator_t * grown = realloc(broadcast->spectators, sizeof(spectator_t) * capacity);
+            if (!grown)
+            {
+                close(fd);
+                return;
+            }
+            broadcast->spectators = grown;
+            broadcast->capacity   = capacity;
+        }
+
+        broadcast->spectators[broadcast->count++] = (spectator_t) { .fd = fd };
+    }
+}
+
+static void broadcast_drop_(borrowed broadcast_t * broadcast, copied uint32_t idx)
+{
+    borrowed spectator_t * spectator = &broadcast->spectators[idx];
+    for (uint32_t i = 0; i < spectator->count; i++)
+    {
+        frame_release_(spectator->queue[(spectator->head + i) % BROADCAST_QUEUE]);
+    }
+    close(spectator->fd);
+
+    /* swap-remove, order of spectators does not matter */
+    broadcast->spectators[idx] = broadcast->spectators[--broadcast->count];
+}
+
+static copied bool broadcast_reserve_(borrowed broadcast_t * broadcast, copied uint32_t count)
+{
+    if (count <= broadcast->fds_capacity)
+    {
+        return true;
+    }
+
+    copied uint32_t capacity = broadcast->fds_capacity ? broadcast->fds_capacity : 16;
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+    owned struct pollfd * grown = realloc(broadcast->fds, sizeof(struct pollfd) * capacity);
+    if (!grown)
+    {
+        return false;
+    }
+    broadcast->fds          = grown;
+    broadcast->fds_capacity = capacity;
+    return true;
+}
+
+/* Sends queued frames straight from the shared buffers. Returns false if the peer is gone. */
+static copied bool broadcast_flush_(borrowed spectator_t * spectator)
+{
+    while (spectator->count > 0)
+    {
+        copied struct iovec iov[BROADCAST_QUEUE];
+        for (uint32_t i = 0; i < spectator->count; i++)
+        {
+            borrowed frame_t * frame = spectator->queue[(spectator->head + i) % BROADCAST_QUEUE];
+            copied uint32_t    skip  = (i == 0) ? spectator->offset : 0;
+            iov[i] = (struct iovec) { .iov_base = frame->data + skip, .iov_len = frame->len - skip };
+        }
+
+        copied struct msghdr msg = { .msg_iov = iov, .msg_iovlen = spectator->count };
+        copied ssize_t n = sendmsg(spectator->fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        copied size_t sent = cast(n, size_t) + spectator->offset;
+        spectator->offset = 0;
+        while (spectator->count > 0)
+        {
+            borrowed frame_t * frame = spectator->queue[spectator->head];
+            if (sent < frame->len)
+            {
+                spectator->offset = cast(sent, uint32_t);
+                return true;    /* socket buffer is full, keep the rest queued */
+            }
+            sent -= frame->len;
+            frame_release_(frame);
+            spectator->head = (spectator->head + 1) % BROADCAST_QUEUE;
+            spectator->count--;
+        }
+    }
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Frames
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static owned frame_t * frame_serialize_(borrowed const broadcast_round_t * round)
+{
+    static const char * const moves[moves_count] = { "rock", "paper", "scissors" };
+    static const char * const results[3]         = { "draw", "win", "lose" };
+
+    owned frame_t * frame = malloc(sizeof(frame_t) + BROADCAST_FRAME_MAX);
+    if (!frame)
+    {
+        return nil;
+    }
+
+    copied int len = snprintf(frame->data, BROADCAST_FRAME_MAX,
+                              "round=%llu player=%s computer=%s result=%s styles=%d,%d,%d\n",
+                              cast(round->round, unsigned long long),
+                              moves[round->player], moves[round->computer], results[round->result],
+                              round->styles[0], round->styles[1], round->styles[2]);
+    frame->refs = 0;
+    frame->len  = (len < BROADCAST_FRAME_MAX) ? cast(len, uint32_t) : BROADCAST_FRAME_MAX - 1;
+    return frame;
+}
+
+static void frame_release_(owned frame_t * frame)
+{
+    if (--frame->refs == 0)
+    {
+        free(frame);
+    }
+}
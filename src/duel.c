@@ -0,0 +1,243 @@
+/* syscall() and SYS_futex are not part of POSIX */
+#define _DEFAULT_SOURCE
+
+#include "duel.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define DUEL_SPINS          (2000)          /* busy polls before sleeping on the futex */
+#define DUEL_TIMEOUT_NS     (250000000L)    /* futex sleep slice, then check the peer is alive */
+#define DUEL_SETUP_TRIES    (100)           /* 1ms polls for a creator that is still initializing */
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void        duel_futex_wait_(borrowed _Atomic uint32_t * word, copied uint32_t expected, copied long timeout_ns);
+static void        duel_futex_wake_(borrowed _Atomic uint32_t * word);
+static copied bool duel_peer_alive_(borrowed duel_t * duel);
+static copied bool duel_wait_initialized_(copied int fd);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Lifecycle
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool duel_open(borrowed duel_t * duel, borrowed const char * name)
+{
+    memset(duel, 0, sizeof(*duel));
+    if (cast(snprintf(duel->name, sizeof(duel->name), "/rps-duel-%s", name), size_t) >= sizeof(duel->name))
+    {
+        return false;
+    }
+
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        copied int  fd      = shm_open(duel->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        copied bool creator = fd >= 0;
+        if (!creator && errno == EEXIST)
+        {
+            fd = shm_open(duel->name, O_RDWR, 0600);
+        }
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        if (creator && ftruncate(fd, sizeof(duel_shm_t)) < 0)
+        {
+            close(fd);
+            shm_unlink(duel->name);
+            return false;
+        }
+        if (!creator && !duel_wait_initialized_(fd))
+        {
+            close(fd);
+            shm_unlink(duel->name);
+            continue;
+        }
+
+        borrowed void * map = mmap(nil, sizeof(duel_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+        {
+            return false;
+        }
+        duel->shm = map;
+
+        if (creator)
+        {
+            /* fresh segments are zero-filled, publish the magic last */
+            duel->side = 0;
+            duel->shm->pids[0] = getpid();
+            atomic_store_explicit(&duel->shm->magic, DUEL_MAGIC, memory_order_release);
+            return true;
+        }
+
+        /* joining: a segment already joined (or never initialized) is stale, replace it */
+        copied struct timespec pause = { .tv_sec = 0, .tv_nsec = 1000000L };
+        for (int i = 0; i < DUEL_SETUP_TRIES && atomic_load(&duel->shm->magic) != DUEL_MAGIC; i++)
+        {
+            nanosleep(&pause, nil);
+        }
+
+        copied uint32_t expected = 0;
+        duel->side = 1;
+        if (atomic_load_explicit(&duel->shm->magic, memory_order_acquire) == DUEL_MAGIC &&
+            duel_peer_alive_(duel) &&
+            atomic_compare_exchange_strong(&duel->shm->joined, &expected, 1))
+        {
+            duel->shm->pids[1] = getpid();
+            duel_futex_wake_(&duel->shm->joined);
+            shm_unlink(duel->name);     /* both sides have it mapped, the name is no longer needed */
+            return true;
+        }
+
+        munmap(duel->shm, sizeof(duel_shm_t));
+        duel->shm = nil;
+        shm_unlink(duel->name);
+    }
+    return false;
+}
+
+copied bool duel_wait_peer(borrowed duel_t * duel)
+{
+    while (0 == atomic_load_explicit(&duel->shm->joined, memory_order_acquire))
+    {
+        duel_futex_wait_(&duel->shm->joined, 0, DUEL_TIMEOUT_NS);
+    }
+    return true;
+}
+
+void duel_close(borrowed duel_t * duel)
+{
+    if (!duel->shm)
+    {
+        return;
+    }
+
+    duel_send(duel, DUEL_QUIT);
+    if (duel->side == 0 && 0 == atomic_load(&duel->shm->joined))
+    {
+        shm_unlink(duel->name);     /* nobody joined, do not leave the segment behind */
+    }
+    munmap(duel->shm, sizeof(duel_shm_t));
+    duel->shm = nil;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Messaging
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool duel_send(borrowed duel_t * duel, copied uint8_t message)
+{
+    borrowed duel_ring_t * ring = &duel->shm->rings[duel->side];
+
+    copied uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    copied uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail == DUEL_RING)
+    {
+        return false;   /* peer stopped reading */
+    }
+
+    ring->slots[head % DUEL_RING] = message;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    duel_futex_wake_(&ring->head);
+    return true;
+}
+
+copied uint8_t duel_recv(borrowed duel_t * duel)
+{
+    copied int32_t message;
+    while ((message = duel_recv_timeout(duel, DUEL_TIMEOUT_NS / 1000000L)) < 0)
+    {
+    }
+    return cast(message, uint8_t);
+}
+
+copied int32_t duel_recv_timeout(borrowed duel_t * duel, copied int timeout_ms)
+{
+    borrowed duel_ring_t * ring = &duel->shm->rings[1 - duel->side];
+    copied   uint32_t      tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    copied   int64_t       left = cast(timeout_ms, int64_t) * 1000000L;
+
+    for (uint32_t spins = 0; ; spins++)
+    {
+        copied uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (head != tail)
+        {
+            copied uint8_t message = ring->slots[tail % DUEL_RING];
+            atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+            return message;
+        }
+
+        if (spins < DUEL_SPINS)
+        {
+            continue;
+        }
+
+        if (!duel_peer_alive_(duel))
+        {
+            return DUEL_QUIT;
+        }
+        if (left <= 0)
+        {
+            return -1;
+        }
+
+        /* a wake or a signal ends the slice early; either way the ring is looked at again */
+        copied long slice = (left < DUEL_TIMEOUT_NS) ? cast(left, long) : DUEL_TIMEOUT_NS;
+        duel_futex_wait_(&ring->head, head, slice);
+        left -= slice;
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void duel_futex_wait_(borrowed _Atomic uint32_t * word, copied uint32_t expected, copied long timeout_ns)
+{
+    copied struct timespec timeout = { .tv_sec = 0, .tv_nsec = timeout_ns };
+    syscall(SYS_futex, word, FUTEX_WAIT, expected, &timeout, nil, 0);
+}
+
+static void duel_futex_wake_(borrowed _Atomic uint32_t * word)
+{
+    syscall(SYS_futex, word, FUTEX_WAKE, 1, nil, nil, 0);
+}
+
+/* The creator may not have sized the segment yet; mapping it early would fault. */
+static copied bool duel_wait_initialized_(copied int fd)
+{
+    copied struct timespec pause = { .tv_sec = 0, .tv_nsec = 1000000L };
+    for (int i = 0; i < DUEL_SETUP_TRIES; i++)
+    {
+        copied struct stat st;
+        if (fstat(fd, &st) < 0)
+        {
+            return false;
+        }
+        if (st.st_size >= cast(sizeof(duel_shm_t), off_t))
+        {
+            return true;
+        }
+        nanosleep(&pause, nil);
+    }
+    return false;
+}
+
+static copied bool duel_peer_alive_(borrowed duel_t * duel)
+{
+    copied pid_t peer = duel->shm->pids[1 - duel->side];
+    return peer == 0 || 0 == kill(peer, 0) || errno != ESRCH;
+}
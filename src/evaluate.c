@@ -0,0 +1,208 @@
+#include "evaluate.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "game.h"
+#include "rng.h"
+#include "table.h"
+#include "markov.h"
+#include "simulate.h"
+#include "monotonic.h"
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool  evaluate_player_(borrowed const evaluate_config_t * config, borrowed markov_policy_t * player);
+static copied bool  evaluate_exact_(borrowed const evaluate_config_t * config, borrowed const markov_policy_t * player);
+static copied bool  evaluate_simulate_(borrowed const evaluate_config_t * config, borrowed const markov_policy_t * player);
+static copied move_t evaluate_sample_(borrowed const f64 * moves, borrowed rng_t * rng);
+static void         evaluate_print_(borrowed const evaluate_config_t * config, borrowed const f64 * rates, copied f64 margin);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool evaluate(borrowed const evaluate_config_t * config)
+{
+    copied markov_policy_t player;
+    if (!evaluate_player_(config, &player))
+    {
+        return false;
+    }
+
+    copied bool finite = !config->opponent.bot_path
+                      && (config->opponent.table_path || 0 == strcmp(config->opponent.name, "random"));
+    return finite ? evaluate_exact_(config, &player) : evaluate_simulate_(config, &player);
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool evaluate_player_(borrowed const evaluate_config_t * config, borrowed markov_policy_t * player)
+{
+    copied uint8_t moves[TABLE_SIZE];
+    copied reference_t reference;
+    if (config->player_table)
+    {
+        borrowed const char * error = nil;
+        if (!table_load(config->player_table, moves, &error))
+        {
+            fprintf(stderr, "rps: %s: %s\n", config->player_table, error);
+            return false;
+        }
+        markov_policy_table(player, moves);
+        markov_policy_mirror(player);
+    }
+    else if (0 == strcmp(config->player, "random"))
+    {
+        markov_policy_uniform(player);
+    }
+    else if (table_reference_parse(config->player, &reference))
+    {
+        table_reference(reference, moves);
+        markov_policy_table(player, moves);
+    }
+    else
+    {
+        fprintf(stderr, "rps: unknown player %s (expected random or one of: " TABLE_REFERENCE_NAMES ")\n", config->player);
+        return false;
+    }
+    markov_policy_noise(player, config->noise);
+    return true;
+}
+
+static copied bool evaluate_exact_(borrowed const evaluate_config_t * config, borrowed const markov_policy_t * player)
+{
+    copied markov_policy_t computer;
+    if (config->opponent.table_path)
+    {
+        copied uint8_t moves[TABLE_SIZE];
+        borrowed const char * error = nil;
+        if (!table_load(config->opponent.table_path, moves, &error))
+        {
+            fprintf(stderr, "rps: %s: %s\n", config->opponent.table_path, error);
+            return false;
+        }
+        markov_policy_table(&computer, moves);
+    }
+    else
+    {
+        markov_policy_uniform(&computer);
+    }
+
+    copied markov_result_t result;
+    copied f64  start   = monotonic_seconds();
+    copied bool settled = markov_evaluate(player, &computer, &result);
+    copied f64  elapsed = monotonic_seconds() - start;
+
+    printf("method:        exact, %u-state chain, %u iterations%s\n",
+           MARKOV_STATES, result.iterations, settled ? "" : " (not converged)");
+    evaluate_print_(config, result.rates, 0.0);
+    printf("elapsed:       %.3fs\n", elapsed);
+    return true;
+}
+
+/* Plays the player's policy against the real opponent, as simulate() plays a random player. */
+static copied bool evaluate_simulate_(borrowed const evaluate_config_t * config, borrowed const markov_policy_t * player)
+{
+    copied strategy_t opponent;
+    copied bot_t      bot = { 0 };
+    borrowed const char * error = nil;
+    if (!strategy_load(&opponent, &bot, &config->opponent, &error))
+    {
+        fprintf(stderr, "rps: %s\n", error);
+        return false;
+    }
+
+    copied history_t history;
+    if (!history_init(&history, HISTORY_WINDOW))
+    {
+        fprintf(stderr, "rps: out of memory\n");
+        strategy_destroy(&opponent);
+        bot_unload(&bot);
+        return false;
+    }
+
+    copied rng_t rng;
+    rng_seed(&rng, config->opponent.seed, RNG_STREAM_PLAYER);
+
+    copied uint8_t  computer[SIMULATE_BATCH];
+    copied uint64_t tally[3] = { 0 };
+    copied uint8_t  context  = 0;
+    copied f64      start    = monotonic_seconds();
+    for (uint64_t done = 0; done < config->rounds; )
+    {
+        copied uint32_t n = (config->rounds - done < SIMULATE_BATCH) ? cast(config->rounds - done, uint32_t) : SIMULATE_BATCH;
+        if (n > opponent.batch)
+        {
+            n = opponent.batch;
+        }
+
+        strategy_choose_n(&opponent, &history, n, computer);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            copied move_t move = evaluate_sample_(player->moves[context], &rng);
+            tally[judge(move, cast(computer[i], move_t))]++;
+            history_push(&history, move, cast(computer[i], move_t));
+            strategy_observe(&opponent, move, cast(computer[i], move_t));
+            context = TABLE_NEXT(context, move, computer[i]);
+        }
+        done += n;
+    }
+    copied f64 elapsed = monotonic_seconds() - start;
+
+    copied f64 rates[3];
+    copied f64 rounds = config->rounds ? cast(config->rounds, f64) : 1.0;
+    for (uint32_t r = 0; r < 3; r++)
+    {
+        rates[r] = cast(tally[r], f64) / rounds;
+    }
+
+    /* the widest 95% interval of the three rates, p = 1/2 bounds them all */
+    printf("method:        simulated, %llu rounds (%s is not finite-memory)\n",
+           cast(config->rounds, unsigned long long), opponent.name);
+    evaluate_print_(config, rates, 1.96 * sqrt(0.25 / rounds));
+    printf("elapsed:       %.3fs\n", elapsed);
+
+    history_free(&history);
+    strategy_destroy(&opponent);
+    bot_unload(&bot);
+    return true;
+}
+
+static copied move_t evaluate_sample_(borrowed const f64 * moves, borrowed rng_t * rng)
+{
+    copied f64 u = cast(rng_next(rng), f64) * (1.0 / 4294967296.0);
+    if (u < moves[move_rock])
+    {
+        return move_rock;
+    }
+    return (u < moves[move_rock] + moves[move_paper]) ? move_paper : move_scissors;
+}
+
+static void evaluate_print_(borrowed const evaluate_config_t * config, borrowed const f64 * rates, copied f64 margin)
+{
+    borrowed const char * opponent = config->opponent.bot_path   ? config->opponent.bot_path
+                                    : config->opponent.table_path ? config->opponent.table_path
+                                    : config->opponent.name;
+    borrowed const char * player    = config->player_table ? config->player_table : config->player;
+
+    printf("opponent:      %s\n", opponent);
+    printf("player:        %s, %.0f%% noise\n", player, config->noise * 100.0);
+    if (margin > 0.0)
+    {
+        printf("opponent wins: %.6f ± %.6f\n", rates[result_lose], margin);
+        printf("player wins:   %.6f ± %.6f\n", rates[result_win], margin);
+        printf("draws:         %.6f ± %.6f\n", rates[result_draw], margin);
+    }
+    else
+    {
+        printf("opponent wins: %.10f\n", rates[result_lose]);
+        printf("player wins:   %.10f\n", rates[result_win]);
+        printf("draws:         %.10f\n", rates[result_draw]);
+    }
+}
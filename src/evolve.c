@@ -0,0 +1,430 @@
+#include "evolve.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "game.h"
+#include "rng.h"
+#include "table.h"
+#include "perf.h"
+#include "monotonic.h"
+
+#define EVOLVE_POOL         (TABLE_REFERENCES)  /* reference players, see table.h */
+#define EVOLVE_CHUNK        (8)         /* candidates per work item */
+#define EVOLVE_LANES        (EVOLVE_POOL * EVOLVE_CHUNK)
+#define EVOLVE_NOISE        (0x19999999u)   /* ~10% of reference moves are random */
+#define EVOLVE_ELITES       (4)         /* fittest candidates copied unchanged */
+#define EVOLVE_TOURNAMENT   (3)
+#define EVOLVE_MUTATION     (0x06522c3fu)   /* ~2 genes in 81 redrawn per child */
+
+typedef struct {
+    copied f32      fitness;
+    copied uint32_t index;
+} evolve_rank_t;
+
+typedef struct {
+    borrowed const evolve_config_t * config;
+
+    /* the population, TABLE_SIZE genes per candidate, and the next one being bred */
+    owned    uint8_t       * genes;
+    owned    uint8_t       * children;
+    owned    f32           * fitness;
+    owned    evolve_rank_t * ranks;
+    copied   uint8_t         pool[EVOLVE_POOL][TABLE_SIZE];
+    copied   uint32_t        generation;
+
+    /* thread pool: workers sleep until `epoch` moves, then pull chunks until none are left */
+    owned    pthread_t     * threads;
+    copied   uint32_t        thread_count;
+    copied   pthread_mutex_t lock;
+    copied   pthread_cond_t  wake;
+    copied   pthread_cond_t  idle;
+    copied   uint32_t        epoch;
+    copied   uint32_t        running;
+    copied   bool            stop;
+    copied   uint32_t        chunks;
+    _Atomic  uint32_t        next_chunk;
+} evolve_t;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void         evolve_pool_build_(borrowed evolve_t * ev);
+static copied bool  evolve_threads_start_(borrowed evolve_t * ev);
+static void         evolve_threads_stop_(borrowed evolve_t * ev);
+static void       * evolve_worker_(borrowed void * arg);
+static void         evolve_evaluate_(borrowed evolve_t * ev, copied uint32_t chunk);
+static void         evolve_breed_(borrowed evolve_t * ev, borrowed rng_t * rng);
+static int          evolve_rank_compare_(borrowed const void * a, borrowed const void * b);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool evolve(borrowed const evolve_config_t * config)
+{
+    copied evolve_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.config       = config;
+    ev.chunks       = (config->population + EVOLVE_CHUNK - 1) / EVOLVE_CHUNK;
+    ev.thread_count = config->threads;
+    if (ev.thread_count == 0)
+    {
+        copied long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        ev.thread_count = (cpus > 0) ? cast(cpus, uint32_t) : 1;
+    }
+
+    ev.genes    = malloc(cast(config->population, size_t) * TABLE_SIZE);
+    ev.children = malloc(cast(config->population, size_t) * TABLE_SIZE);
+    ev.fitness  = malloc(cast(config->population, size_t) * sizeof(f32));
+    ev.ranks    = malloc(cast(config->population, size_t) * sizeof(evolve_rank_t));
+    copied bool ok = ev.genes && ev.children && ev.fitness && ev.ranks;
+    if (!ok)
+    {
+        fprintf(stderr, "rps: out of memory\n");
+    }
+
+    copied rng_t rng;
+    rng_seed(&rng, config->seed, RNG_STREAM_EVOLVE);
+
+    /* opened before the workers exist, so they inherit the counters */
+    copied perf_counters_t perf;
+    if (config->perf_counters)
+    {
+        perf_counters_open(&perf);
+    }
+
+    if (ok)
+    {
+        rng_moves(&rng, ev.genes, config->population * TABLE_SIZE);
+        evolve_pool_build_(&ev);
+        ok = evolve_threads_start_(&ev);
+    }
+
+    if (config->perf_counters)
+    {
+        perf_counters_start(&perf);
+    }
+    copied f64 start = monotonic_seconds();
+    for (ev.generation = 0; ok && ev.generation < config->generations; ev.generation++)
+    {
+        /* fitness of every candidate, in parallel */
+        pthread_mutex_lock(&ev.lock);
+        atomic_store(&ev.next_chunk, 0);
+        ev.running = ev.thread_count;
+        ev.epoch++;
+        pthread_cond_broadcast(&ev.wake);
+        while (ev.running > 0)
+        {
+            pthread_cond_wait(&ev.idle, &ev.lock);
+        }
+        pthread_mutex_unlock(&ev.lock);
+
+        copied f64 mean = 0.0;
+        for (uint32_t i = 0; i < config->population; i++)
+        {
+            ev.ranks[i] = (evolve_rank_t) { .fitness = ev.fitness[i], .index = i };
+            mean += ev.fitness[i];
+        }
+        qsort(ev.ranks, config->population, sizeof(evolve_rank_t), evolve_rank_compare_);
+
+        printf("generation %4u  best %.4f  mean %.4f\n", ev.generation + 1, ev.ranks[0].fitness, mean / config->population);
+        fflush(stdout);
+
+        /* the last generation is kept as evaluated, so ranks[0] is the winner */
+        if (ev.generation + 1 < config->generations)
+        {
+            evolve_breed_(&ev, &rng);
+        }
+    }
+    copied f64 elapsed = monotonic_seconds() - start;
+    if (config->perf_counters)
+    {
+        perf_counters_stop(&perf);
+    }
+
+    if (ev.threads)
+    {
+        evolve_threads_stop_(&ev);
+    }
+
+    if (ok && config->generations > 0)
+    {
+        copied uint64_t games = cast(config->generations, uint64_t) * config->population * EVOLVE_POOL * config->rounds;
+        printf("elapsed:       %.3fs (%.1f ns/round, %u threads)\n", elapsed, games ? elapsed * 1e9 / cast(games, f64) : 0.0, ev.thread_count);
+        if (config->perf_counters)
+        {
+            perf_counters_report(&perf, games, stdout);
+        }
+
+        copied char comment[128];
+        snprintf(comment, sizeof(comment), "rps evolve: fitness %.4f, seed %llu, %u generations",
+                 ev.ranks[0].fitness, cast(config->seed, unsigned long long), config->generations);
+        ok = table_save(config->out, &ev.genes[cast(ev.ranks[0].index, size_t) * TABLE_SIZE], comment);
+        if (ok)
+        {
+            printf("saved:         %s\n", config->out);
+        }
+        else
+        {
+            perror(config->out);
+        }
+    }
+
+    if (config->perf_counters)
+    {
+        perf_counters_close(&perf);
+    }
+    free(ev.genes);
+    free(ev.children);
+    free(ev.fitness);
+    free(ev.ranks);
+    return ok;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Reference Pool
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void evolve_pool_build_(borrowed evolve_t * ev)
+{
+    for (uint32_t r = 0; r < EVOLVE_POOL; r++)
+    {
+        table_reference(cast(r, reference_t), ev->pool[r]);
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Fitness
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/*
+ * Plays every candidate of `chunk` against every reference player, one lane per pair.
+ * Fitness is the computer's average score, 1 for a win and 0.5 for a draw.
+ */
+static void evolve_evaluate_(borrowed evolve_t * ev, copied uint32_t chunk)
+{
+    copied uint32_t first = chunk * EVOLVE_CHUNK;
+    copied uint32_t count = ev->config->population - first;
+    count = (count < EVOLVE_CHUNK) ? count : EVOLVE_CHUNK;
+    copied uint32_t lanes = count * EVOLVE_POOL;
+
+    copied const uint8_t * genes[EVOLVE_LANES];
+    copied const uint8_t * reference[EVOLVE_LANES];
+    copied rng_t           noise[EVOLVE_LANES];
+    copied uint8_t         context[EVOLVE_LANES];
+    copied uint8_t         player[EVOLVE_LANES];
+    copied uint8_t         computer[EVOLVE_LANES];
+    copied uint8_t         results[EVOLVE_LANES];
+    copied uint32_t        points[EVOLVE_LANES];   /* half-points of the computer */
+
+    for (uint32_t lane = 0; lane < lanes; lane++)
+    {
+        copied uint32_t r = lane % EVOLVE_POOL;
+        genes[lane]     = &ev->genes[cast(first + lane / EVOLVE_POOL, size_t) * TABLE_SIZE];
+        reference[lane] = ev->pool[r];
+        context[lane]   = 0;
+        points[lane]    = 0;
+
+        /* seeded by generation and reference only: every candidate meets the same noise */
+        rng_seed(&noise[lane], ev->config->seed + cast(ev->generation, uint64_t) * EVOLVE_POOL + r, RNG_STREAM_NOISE);
+    }
+
+    for (uint32_t round = 0; round < ev->config->rounds; round++)
+    {
+        for (uint32_t lane = 0; lane < lanes; lane++)
+        {
+            computer[lane] = genes[lane][context[lane]];
+            player[lane]   = reference[lane][context[lane]];
+        }
+        for (uint32_t lane = 0; lane < lanes; lane++)
+        {
+            if (rng_next(&noise[lane]) < EVOLVE_NOISE)
+            {
+                player[lane] = cast(rng_below(&noise[lane], moves_count), uint8_t);
+            }
+        }
+
+        judge_n(player, computer, lanes, results);
+
+        for (uint32_t lane = 0; lane < lanes; lane++)
+        {
+            /* result_t is the player's view: draw 0, win 1, lose 2 */
+            points[lane] += (results[lane] == result_lose) * 2u + (results[lane] == result_draw);
+            context[lane] = TABLE_NEXT(context[lane], player[lane], computer[lane]);
+        }
+    }
+
+    copied f32 games = 2.0f * cast(ev->config->rounds, f32) * EVOLVE_POOL;
+    for (uint32_t c = 0; c < count; c++)
+    {
+        copied uint32_t total = 0;
+        for (uint32_t r = 0; r < EVOLVE_POOL; r++)
+        {
+            total += points[c * EVOLVE_POOL + r];
+        }
+        ev->fitness[first + c] = (games > 0.0f) ? cast(total, f32) / games : 0.0f;
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Breeding
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/* Elites survive as they are; every other child is a uniform crossover of two
+ * tournament winners with a few genes redrawn. `ranks` must be sorted. */
+static void evolve_breed_(borrowed evolve_t * ev, borrowed rng_t * rng)
+{
+    copied uint32_t population = ev->config->population;
+    copied uint32_t elites     = (population < EVOLVE_ELITES) ? population : EVOLVE_ELITES;
+
+    for (uint32_t i = 0; i < elites; i++)
+    {
+        memcpy(&ev->children[cast(i, size_t) * TABLE_SIZE], &ev->genes[cast(ev->ranks[i].index, size_t) * TABLE_SIZE], TABLE_SIZE);
+    }
+
+    for (uint32_t i = elites; i < population; i++)
+    {
+        copied const uint8_t * parents[2];
+        for (int p = 0; p < 2; p++)
+        {
+            /* the lowest rank position drawn is the fittest contender */
+            copied uint32_t best = population;
+            for (int t = 0; t < EVOLVE_TOURNAMENT; t++)
+            {
+                copied uint32_t pick = rng_below(rng, population);
+                best = (pick < best) ? pick : best;
+            }
+            parents[p] = &ev->genes[cast(ev->ranks[best].index, size_t) * TABLE_SIZE];
+        }
+
+        borrowed uint8_t * child = &ev->children[cast(i, size_t) * TABLE_SIZE];
+        copied   uint32_t  bits  = 0;
+        for (uint32_t g = 0; g < TABLE_SIZE; g++)
+        {
+            if (g % 32 == 0)
+            {
+                bits = rng_next(rng);
+            }
+            child[g] = parents[bits & 1][g];
+            bits >>= 1;
+
+            if (rng_next(rng) < EVOLVE_MUTATION)
+            {
+                child[g] = cast(rng_below(rng, moves_count), uint8_t);
+            }
+        }
+    }
+
+    borrowed uint8_t * swap = ev->genes;
+    ev->genes    = ev->children;
+    ev->children = swap;
+}
+
+static int evolve_rank_compare_(borrowed const void * a, borrowed const void * b)
+{
+    copied f32 fa = cast(a, const evolve_rank_t *)->fitness;
+    copied f32 fb = cast(b, const evolve_rank_t *)->fitness;
+    if (fa != fb)
+    {
+        return (fa > fb) ? -1 : 1;
+    }
+    /* ties by index, so qsort's instability never changes the outcome */
+    return (cast(a, const evolve_rank_t *)->index < cast(b, const evolve_rank_t *)->index) ? -1 : 1;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Thread Pool
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool evolve_threads_start_(borrowed evolve_t * ev)
+{
+    ev->threads = calloc(ev->thread_count, sizeof(pthread_t));
+    if (!ev->threads)
+    {
+        fprintf(stderr, "rps: out of memory\n");
+        return false;
+    }
+    pthread_mutex_init(&ev->lock, nil);
+    pthread_cond_init(&ev->wake, nil);
+    pthread_cond_init(&ev->idle, nil);
+
+    for (uint32_t i = 0; i < ev->thread_count; i++)
+    {
+        if (0 != pthread_create(&ev->threads[i], nil, evolve_worker_, ev))
+        {
+            /* run with the workers we have */
+            ev->thread_count = i;
+            break;
+        }
+    }
+    if (ev->thread_count == 0)
+    {
+        fprintf(stderr, "rps: cannot start worker threads\n");
+        evolve_threads_stop_(ev);
+        return false;
+    }
+    return true;
+}
+
+static void evolve_threads_stop_(borrowed evolve_t * ev)
+{
+    pthread_mutex_lock(&ev->lock);
+    ev->stop = true;
+    pthread_cond_broadcast(&ev->wake);
+    pthread_mutex_unlock(&ev->lock);
+
+    for (uint32_t i = 0; i < ev->thread_count; i++)
+    {
+        pthread_join(ev->threads[i], nil);
+    }
+    pthread_cond_destroy(&ev->idle);
+    pthread_cond_destroy(&ev->wake);
+    pthread_mutex_destroy(&ev->lock);
+    free(ev->threads);
+    ev->threads = nil;
+}
+
+static void * evolve_worker_(borrowed void * arg)
+{
+    borrowed evolve_t * ev   = arg;
+    copied   uint32_t   seen = 0;
+
+    pthread_mutex_lock(&ev->lock);
+    for (;;)
+    {
+        while (!ev->stop && ev->epoch == seen)
+        {
+            pthread_cond_wait(&ev->wake, &ev->lock);
+        }
+        if (ev->stop)
+        {
+            break;
+        }
+        seen = ev->epoch;
+        pthread_mutex_unlock(&ev->lock);
+
+        for (;;)
+        {
+            copied uint32_t chunk = atomic_fetch_add(&ev->next_chunk, 1);
+            if (chunk >= ev->chunks)
+            {
+                break;
+            }
+            evolve_evaluate_(ev, chunk);
+        }
+
+        pthread_mutex_lock(&ev->lock);
+        if (--ev->running == 0)
+        {
+            pthread_cond_signal(&ev->idle);
+        }
+    }
+    pthread_mutex_unlock(&ev->lock);
+    return nil;
+}
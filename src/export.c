@@ -0,0 +1,376 @@
+#include "export.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "game.h"
+#include "roundlog.h"
+
+#define EXPORT_PATH_MAX     (4096)
+#define EXPORT_RECORDS      (8192)                  /* 256 KiB of records per read() */
+#define EXPORT_OUTPUT       (256 * 1024)            /* bytes per write() */
+#define EXPORT_ROW_MAX      (256)                   /* longest formatted row, escaping included */
+
+#define CSV_HEADER          "time_ns,round,strategy,player,computer,result\n"
+
+/* A literal and its length, formatted rows are assembled from these. */
+typedef struct {
+    borrowed const char * bytes;
+    copied   size_t       len;
+} export_text_t;
+
+#define TEXT(s)             { .bytes = (s), .len = sizeof(s) - 1 }
+
+static const export_text_t _moves[moves_count] = {
+    [move_rock]     = TEXT("rock"),
+    [move_paper]    = TEXT("paper"),
+    [move_scissors] = TEXT("scissors"),
+};
+
+static const export_text_t _results[3] = {
+    [result_draw] = TEXT("draw"),
+    [result_win]  = TEXT("win"),
+    [result_lose] = TEXT("lose"),
+};
+
+static const export_text_t _unknown = TEXT("unknown");
+
+/* Two-digit pairs "00".."99", halves the divisions when formatting integers */
+static const char _digits[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/* Buffers of one export run, on the heap so concurrent exports never share them */
+typedef struct {
+    copied roundlog_record_t records[EXPORT_RECORDS];
+    copied char              output[EXPORT_OUTPUT];
+    copied size_t            used;
+    copied int               out;
+
+    /* the strategy name is the same for long runs of rows, escape it once per run */
+    copied char              strategy[ROUNDLOG_NAME_MAX];
+    copied char              escaped[ROUNDLOG_NAME_MAX * 6];
+    copied size_t            escaped_len;
+} export_state_t;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool   export_run_(borrowed export_state_t * ex, copied export_format_t format, copied int out);
+static copied bool   export_flush_(borrowed export_state_t * ex);
+static copied char * export_u64_(borrowed char * p, copied uint64_t value);
+static copied char * export_text_(borrowed char * p, borrowed const export_text_t * text);
+static copied char * export_strategy_(borrowed export_state_t * ex, borrowed char * p, borrowed const char * name, copied export_format_t format);
+static copied char * export_row_(borrowed export_state_t * ex, borrowed char * p, borrowed const roundlog_record_t * record, copied export_format_t format);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool export_format_parse(borrowed const char * name, borrowed export_format_t * format)
+{
+    if (0 == strcmp(name, "csv"))
+    {
+        *format = export_csv;
+        return true;
+    }
+    if (0 == strcmp(name, "jsonl"))
+    {
+        *format = export_jsonl;
+        return true;
+    }
+    return false;
+}
+
+copied bool export_rounds(copied export_format_t format, copied int out)
+{
+    owned export_state_t * ex = malloc(sizeof(export_state_t));
+    if (!ex)
+    {
+        perror("rps: export");
+        return false;
+    }
+
+    /* a reader that stops early (`| head`) must surface as EPIPE, not kill the process */
+    signal(SIGPIPE, SIG_IGN);
+
+    copied bool ok = export_run_(ex, format, out);
+    free(ex);
+    return ok;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Export Loop
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool export_run_(borrowed export_state_t * ex, copied export_format_t format, copied int out)
+{
+    ex->out         = out;
+    ex->used        = 0;
+    ex->escaped_len = 0;
+    memset(ex->strategy, 0, sizeof(ex->strategy));
+    ex->strategy[0] = '\xff';   /* matches no real name, forces the first escape */
+
+    copied char path[EXPORT_PATH_MAX];
+    if (!roundlog_path(path, sizeof(path)))
+    {
+        fprintf(stderr, "rps: no round log (set " ROUNDLOG_ENV " or HOME)\n");
+        return false;
+    }
+
+    if (format == export_csv)
+    {
+        memcpy(ex->output, CSV_HEADER, sizeof(CSV_HEADER) - 1);
+        ex->used = sizeof(CSV_HEADER) - 1;
+    }
+
+    copied int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0 && errno == ENOENT)
+    {
+        /* nothing played yet is an empty export, not an error */
+        return export_flush_(ex);
+    }
+    if (fd < 0)
+    {
+        perror(path);
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    if (!roundlog_read_header(fd))
+    {
+        fprintf(stderr, "rps: %s is not a round log\n", path);
+        close(fd);
+        return false;
+    }
+
+    /* bytes of a record split across two reads carry over to the front of the buffer */
+    copied size_t pending = 0;
+    for (;;)
+    {
+        copied ssize_t n = read(fd, cast(ex->records, char *) + pending, sizeof(ex->records) - pending);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            perror(path);
+            close(fd);
+            return false;
+        }
+        if (n == 0)
+        {
+            break;      /* a torn record at the very end is dropped */
+        }
+
+        copied size_t bytes = pending + cast(n, size_t);
+        copied size_t count = bytes / sizeof(roundlog_record_t);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (ex->used + EXPORT_ROW_MAX > EXPORT_OUTPUT && !export_flush_(ex))
+            {
+                close(fd);
+                return false;
+            }
+            ex->used = cast(export_row_(ex, ex->output + ex->used, &ex->records[i], format) - ex->output, size_t);
+        }
+
+        pending = bytes - count * sizeof(roundlog_record_t);
+        memmove(ex->records, &ex->records[count], pending);
+    }
+
+    close(fd);
+    return export_flush_(ex);
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Formatting
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied char * export_row_(borrowed export_state_t * ex, borrowed char * p, borrowed const roundlog_record_t * record, copied export_format_t format)
+{
+    borrowed const export_text_t * player   = record->player   < moves_count ? &_moves[record->player]   : &_unknown;
+    borrowed const export_text_t * computer = record->computer < moves_count ? &_moves[record->computer] : &_unknown;
+    borrowed const export_text_t * result   = record->result   < 3           ? &_results[record->result] : &_unknown;
+
+    if (format == export_csv)
+    {
+        p = export_u64_(p, record->time_ns);
+        *p++ = ',';
+        p = export_u64_(p, record->round);
+        *p++ = ',';
+        p = export_strategy_(ex, p, record->strategy, format);
+        *p++ = ',';
+        p = export_text_(p, player);
+        *p++ = ',';
+        p = export_text_(p, computer);
+        *p++ = ',';
+        p = export_text_(p, result);
+        *p++ = '\n';
+        return p;
+    }
+
+    static const export_text_t keys[6] = {
+        TEXT("{\"time_ns\":"),
+        TEXT(",\"round\":"),
+        TEXT(",\"strategy\":\""),
+        TEXT("\",\"player\":\""),
+        TEXT("\",\"computer\":\""),
+        TEXT("\",\"result\":\""),
+    };
+
+    p = export_text_(p, &keys[0]);
+    p = export_u64_(p, record->time_ns);
+    p = export_text_(p, &keys[1]);
+    p = export_u64_(p, record->round);
+    p = export_text_(p, &keys[2]);
+    p = export_strategy_(ex, p, record->strategy, format);
+    p = export_text_(p, &keys[3]);
+    p = export_text_(p, player);
+    p = export_text_(p, &keys[4]);
+    p = export_text_(p, computer);
+    p = export_text_(p, &keys[5]);
+    p = export_text_(p, result);
+    *p++ = '"';
+    *p++ = '}';
+    *p++ = '\n';
+    return p;
+}
+
+static copied char * export_text_(borrowed char * p, borrowed const export_text_t * text)
+{
+    memcpy(p, text->bytes, text->len);
+    return p + text->len;
+}
+
+static copied char * export_u64_(borrowed char * p, copied uint64_t value)
+{
+    copied char   buf[20];
+    copied char * end = buf + sizeof(buf);
+    copied char * q   = end;
+
+    while (value >= 100)
+    {
+        copied uint32_t pair = cast(value % 100, uint32_t);
+        value /= 100;
+        q -= 2;
+        memcpy(q, &_digits[pair * 2], 2);
+    }
+    if (value >= 10)
+    {
+        q -= 2;
+        memcpy(q, &_digits[value * 2], 2);
+    }
+    else
+    {
+        *--q = cast('0' + value, char);
+    }
+
+    memcpy(p, q, cast(end - q, size_t));
+    return p + (end - q);
+}
+
+/*
+ * Escapes the name for the format: CSV quotes it when it holds a comma, quote or line
+ * break, JSON escapes quotes, backslashes and control characters. Cached per name.
+ */
+static copied char * export_strategy_(borrowed export_state_t * ex, borrowed char * p, borrowed const char * name, copied export_format_t format)
+{
+    if (0 != memcmp(name, ex->strategy, ROUNDLOG_NAME_MAX))
+    {
+        memcpy(ex->strategy, name, ROUNDLOG_NAME_MAX);
+
+        copied size_t len = strnlen(name, ROUNDLOG_NAME_MAX);
+        copied char * q   = ex->escaped;
+        if (format == export_csv)
+        {
+            copied bool quote = false;
+            for (size_t i = 0; i < len; i++)
+            {
+                quote |= name[i] == ',' || name[i] == '"' || name[i] == '\n' || name[i] == '\r';
+            }
+            if (quote)
+            {
+                *q++ = '"';
+            }
+            for (size_t i = 0; i < len; i++)
+            {
+                if (name[i] == '"')
+                {
+                    *q++ = '"';
+                }
+                *q++ = name[i];
+            }
+            if (quote)
+            {
+                *q++ = '"';
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < len; i++)
+            {
+                copied unsigned char c = cast(name[i], unsigned char);
+                if (c == '"' || c == '\\')
+                {
+                    *q++ = '\\';
+                    *q++ = cast(c, char);
+                }
+                else if (c < 0x20)
+                {
+                    memcpy(q, "\\u00", 4);
+                    q[4] = "0123456789abcdef"[c >> 4];
+                    q[5] = "0123456789abcdef"[c & 0xf];
+                    q += 6;
+                }
+                else
+                {
+                    *q++ = cast(c, char);
+                }
+            }
+        }
+        ex->escaped_len = cast(q - ex->escaped, size_t);
+    }
+
+    memcpy(p, ex->escaped, ex->escaped_len);
+    return p + ex->escaped_len;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * I/O
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool export_flush_(borrowed export_state_t * ex)
+{
+    borrowed const char * p    = ex->output;
+    copied   size_t       left = ex->used;
+    while (left > 0)
+    {
+        copied ssize_t n = write(ex->out, p, left);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            /* a closed pipe (e.g. `| head`) just ends the export */
+            if (errno != EPIPE)
+            {
+                perror("rps: export");
+            }
+            return false;
+        }
+        p    += n;
+        left -= cast(n, size_t);
+    }
+    ex->used = 0;
+    return true;
+}
@@ -0,0 +1,93 @@
+#include "game.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Rules
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied result_t judge(copied move_t player, copied move_t computer)
+{
+    if (player == computer)
+    {
+        return result_draw;
+    }
+
+    /* Rock beats Scissors, Scissors beats Paper, Paper beats Rock */
+    if ((player == move_rock     && computer == move_scissors) ||
+        (player == move_scissors && computer == move_paper)    ||
+        (player == move_paper    && computer == move_rock))
+    {
+        return result_win;
+    }
+
+    return result_lose;
+}
+
+void judge_n(borrowed const uint8_t * player, borrowed const uint8_t * computer, copied uint32_t n, borrowed uint8_t * results)
+{
+    /* each move beats the one before it, so (player - computer) mod 3 is the result_t */
+    _Static_assert(result_draw == 0 && result_win == 1 && result_lose == 2, "judge_n relies on result_t values");
+    for (uint32_t i = 0; i < n; i++)
+    {
+        results[i] = cast((player[i] + 3 - computer[i]) % 3, uint8_t);
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * History
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool history_init(borrowed history_t * history, copied uint32_t capacity)
+{
+    if (capacity < 2)
+    {
+        capacity = 2;
+    }
+
+    history->rounds   = malloc(sizeof(round_t) * capacity);
+    history->count    = 0;
+    history->capacity = history->rounds ? capacity : 0;
+    history->total    = 0;
+    return history->rounds != nil;
+}
+
+void history_free(borrowed history_t * history)
+{
+    free(history->rounds);
+    history->rounds   = nil;
+    history->count    = 0;
+    history->capacity = 0;
+    history->total    = 0;
+}
+
+void history_push(borrowed history_t * history, copied move_t player, copied move_t computer)
+{
+    if (history->capacity == 0)
+    {
+        return;
+    }
+
+    if (history->count == history->capacity)
+    {
+        copied uint32_t keep = history->capacity / 2;
+        memmove(history->rounds, history->rounds + (history->count - keep), sizeof(round_t) * keep);
+        history->count = keep;
+    }
+
+    history->rounds[history->count++] = (round_t) {
+        .computer = cast(computer, uint8_t),
+        .player   = cast(player, uint8_t),
+    };
+    history->total++;
+}
+
+copied rps_bot_history_t history_view(borrowed const history_t * history)
+{
+    return (rps_bot_history_t) {
+        .rounds = cast(history->rounds, const rps_bot_round_t *),
+        .count  = history->count,
+        .total  = history->total,
+    };
+}
@@ -0,0 +1,463 @@
+/* MAP_ANONYMOUS and MAP_STACK are not part of POSIX */
+#define _DEFAULT_SOURCE
+
+#include "host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "rps.h"
+#include "monotonic.h"
+#include "session.h"
+
+#define SEED_SPACING        (0x9e3779b97f4a7c15ull)     /* golden ratio, spreads the session seeds */
+
+typedef struct host_s      host_t;
+typedef struct host_loop_s host_loop_t;
+
+/* One connected terminal: a session and the coroutine it runs on */
+typedef struct host_client_s {
+    copied   rps_session_t          session;
+    copied   ucontext_t             context;
+    owned    void                 * stack;
+    copied   size_t                 stack_size;
+    borrowed host_loop_t          * loop;
+    copied   int                    fd;
+
+    /* what the session is waiting for; `deadline` is 0 without a timeout */
+    copied   bool                   waiting;
+    copied   bool                   ready;      /* queued for resumption by this wakeup */
+    copied   uint64_t               deadline;
+    copied   bool                   done;
+
+    struct host_client_s          * prev;
+    struct host_client_s          * next;
+} host_client_t;
+
+/* One event loop thread and the sessions it runs */
+struct host_loop_s {
+    borrowed host_t               * host;
+    copied   int                    epoll;
+    copied   ucontext_t             context;    /* where a session returns to when it waits */
+    borrowed host_client_t        * clients;
+    copied   pthread_t              thread;
+};
+
+struct host_s {
+    borrowed const host_config_t  * config;
+    copied   int                    listen_fd;
+    _Atomic  uint64_t               sessions;   /* ever accepted, numbers the seeds */
+    owned    host_loop_t          * loops;
+    copied   uint32_t               count;
+};
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Module State
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/* The client a loop thread just resumed, read by the coroutine entry point */
+static _Thread_local host_client_t * _starting = nil;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void          * host_loop_run_(borrowed void * arg);
+static copied int      host_loop_timeout_(borrowed const host_loop_t * loop);
+static void            host_loop_expire_(borrowed host_loop_t * loop);
+static void            host_accept_(borrowed host_loop_t * loop);
+static void            host_client_start_(borrowed host_loop_t * loop, copied int fd);
+static void            host_client_resume_(borrowed host_client_t * client);
+static void            host_client_free_(owned host_client_t * client);
+static void            host_client_main_(void);
+static copied int      host_client_wait_(borrowed void * context, borrowed struct pollfd * fds, copied int count, copied int timeout_ms);
+static copied int      host_listen_(borrowed const char * path);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool host_serve(borrowed const host_config_t * config)
+{
+    copied host_t host = { .config = config, .listen_fd = -1 };
+
+    host.count = config->threads;
+    if (host.count == 0)
+    {
+        copied long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        host.count = (cpus > 0) ? cast(cpus, uint32_t) : 1;
+    }
+
+    /* fail now rather than in every session */
+    {
+        copied strategy_t     probe;
+        copied bot_t          bot   = { 0 };
+        borrowed const char * error = nil;
+        if (!strategy_load(&probe, &bot, &config->opponent, &error))
+        {
+            fprintf(stderr, "rps: cannot load opponent '%s': %s\n", config->opponent.bot_path ? config->opponent.bot_path : config->opponent.table_path ? config->opponent.table_path : config->opponent.name, error);
+            return false;
+        }
+        strategy_destroy(&probe);
+        bot_unload(&bot);
+    }
+
+    /* a client hanging up mid-write must cost its session, not the host */
+    signal(SIGPIPE, SIG_IGN);
+    assets_measure();
+
+    host.listen_fd = host_listen_(config->path);
+    if (host.listen_fd < 0)
+    {
+        fprintf(stderr, "rps: cannot listen on '%s': %s\n", config->path, strerror(errno));
+        return false;
+    }
+
+    host.loops = calloc(host.count, sizeof(host_loop_t));
+    if (!host.loops)
+    {
+        fprintf(stderr, "rps: out of memory\n");
+        close(host.listen_fd);
+        return false;
+    }
+
+    /* every loop waits on the listening socket; EPOLLEXCLUSIVE wakes only one per client */
+    for (uint32_t i = 0; i < host.count; i++)
+    {
+        borrowed host_loop_t * loop = &host.loops[i];
+        loop->host  = &host;
+        loop->epoll = epoll_create1(EPOLL_CLOEXEC);
+
+        copied struct epoll_event event = { .events = EPOLLIN | EPOLLEXCLUSIVE, .data.ptr = nil };
+        if (loop->epoll < 0 || epoll_ctl(loop->epoll, EPOLL_CTL_ADD, host.listen_fd, &event) < 0)
+        {
+            fprintf(stderr, "rps: cannot create the event loops: %s\n", strerror(errno));
+            for (uint32_t j = 0; j <= i; j++)
+            {
+                if (host.loops[j].epoll >= 0)
+                {
+                    close(host.loops[j].epoll);
+                }
+            }
+            free(host.loops);
+            close(host.listen_fd);
+            return false;
+        }
+    }
+
+    fprintf(stderr, "rps: serving on %s with %u event loop%s\n", config->path, host.count, host.count == 1 ? "" : "s");
+
+    /* the calling thread runs the first loop */
+    for (uint32_t i = 1; i < host.count; i++)
+    {
+        if (0 != pthread_create(&host.loops[i].thread, nil, host_loop_run_, &host.loops[i]))
+        {
+            fprintf(stderr, "rps: cannot start event loop %u\n", i);
+        }
+    }
+    host_loop_run_(&host.loops[0]);
+
+    /* only reached if epoll itself fails */
+    close(host.listen_fd);
+    return false;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Event Loop
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void * host_loop_run_(borrowed void * arg)
+{
+    borrowed host_loop_t * loop = arg;
+
+    copied struct epoll_event events[HOST_EVENTS];
+    borrowed host_client_t *  ready[HOST_EVENTS];
+    for (;;)
+    {
+        copied int n = epoll_wait(loop->epoll, events, HOST_EVENTS, host_loop_timeout_(loop));
+        if (n < 0 && errno != EINTR)
+        {
+            fprintf(stderr, "rps: event loop failed: %s\n", strerror(errno));
+            return nil;
+        }
+
+        /* a client waiting on two descriptors may show up twice, and a resumed client may
+         * finish and be freed: collect each one once before resuming any */
+        copied int count = 0;
+        for (int i = 0; i < n; i++)
+        {
+            borrowed host_client_t * client = events[i].data.ptr;
+            if (!client)
+            {
+                host_accept_(loop);
+            }
+            else if (client->waiting && !client->ready)
+            {
+                client->ready  = true;
+                ready[count++] = client;
+            }
+        }
+        for (int i = 0; i < count; i++)
+        {
+            host_client_resume_(ready[i]);
+        }
+        host_loop_expire_(loop);
+    }
+}
+
+/* Milliseconds until the first session deadline, -1 if none is pending. */
+static copied int host_loop_timeout_(borrowed const host_loop_t * loop)
+{
+    copied uint64_t first = 0;
+    for (borrowed const host_client_t * client = loop->clients; client; client = client->next)
+    {
+        if (client->waiting && client->deadline && (first == 0 || client->deadline < first))
+        {
+            first = client->deadline;
+        }
+    }
+    if (first == 0)
+    {
+        return -1;
+    }
+
+    copied uint64_t now = monotonic_ns();
+    return (first <= now) ? 0 : cast(CEIL_DIV(first - now, NSEC_PER_MSEC), int);
+}
+
+/* Resumes every session whose timeout ran out. */
+static void host_loop_expire_(borrowed host_loop_t * loop)
+{
+    copied uint64_t now = monotonic_ns();
+    for (borrowed host_client_t * client = loop->clients; client; )
+    {
+        borrowed host_client_t * next = client->next;
+        if (client->waiting && client->deadline && client->deadline <= now)
+        {
+            host_client_resume_(client);
+        }
+        client = next;
+    }
+}
+
+static void host_accept_(borrowed host_loop_t * loop)
+{
+    for (;;)
+    {
+        copied int fd = accept(loop->host->listen_fd, nil, nil);
+        if (fd < 0)
+        {
+            /* EAGAIN: another loop took it, or the backlog is empty */
+            return;
+        }
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        host_client_start_(loop, fd);
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Sessions
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void host_client_start_(borrowed host_loop_t * loop, copied int fd)
+{
+    borrowed const host_config_t * config = loop->host->config;
+
+    owned host_client_t * client = calloc(1, sizeof(*client));
+    if (!client)
+    {
+        close(fd);
+        return;
+    }
+    client->loop = loop;
+    client->fd   = fd;
+
+    /* the stack grows down onto an inaccessible page rather than into the heap */
+    copied size_t page = cast(sysconf(_SC_PAGESIZE), size_t);
+    client->stack_size = HOST_STACK + page;
+    client->stack      = mmap(nil, client->stack_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (client->stack == MAP_FAILED)
+    {
+        client->stack = nil;
+        host_client_free_(client);
+        return;
+    }
+    mprotect(client->stack, page, PROT_NONE);
+
+    copied uint64_t serial = atomic_fetch_add_explicit(&loop->host->sessions, 1, memory_order_relaxed);
+    borrowed rps_session_t * s = &client->session;
+    if (!rps_session_init(s, fd, fd, config->opponent.seed + serial * SEED_SPACING))
+    {
+        host_client_free_(client);
+        return;
+    }
+    s->instant         = config->instant;
+    s->ephemeral       = true;
+    s->target_win_rate = config->opponent.target_win_rate;
+
+    borrowed const char * error = nil;
+    if (!rps_session_load_opponent(s, config->opponent.name, config->opponent.bot_path, config->opponent.table_path, &error)
+     || !terminal_buffer(&s->terminal, HOST_BUFFER))
+    {
+        rps_session_fin(s);
+        host_client_free_(client);
+        return;
+    }
+    terminal_wait(&s->terminal, host_client_wait_, client);
+
+    getcontext(&client->context);
+    client->context.uc_stack.ss_sp   = client->stack;
+    client->context.uc_stack.ss_size = client->stack_size;
+    client->context.uc_link          = &loop->context;
+    makecontext(&client->context, host_client_main_, 0);
+
+    client->next = loop->clients;
+    if (loop->clients)
+    {
+        loop->clients->prev = client;
+    }
+    loop->clients = client;
+
+    _starting = client;
+    host_client_resume_(client);
+}
+
+/* Runs `client` until it waits again or finishes; a finished client is freed. */
+static void host_client_resume_(borrowed host_client_t * client)
+{
+    borrowed host_loop_t * loop = client->loop;
+    client->waiting = false;
+    client->ready   = false;
+    swapcontext(&loop->context, &client->context);
+
+    if (!client->done)
+    {
+        return;
+    }
+
+    if (client->prev)
+    {
+        client->prev->next = client->next;
+    }
+    else
+    {
+        loop->clients = client->next;
+    }
+    if (client->next)
+    {
+        client->next->prev = client->prev;
+    }
+    host_client_free_(client);
+}
+
+static void host_client_free_(owned host_client_t * client)
+{
+    if (client->stack)
+    {
+        munmap(client->stack, client->stack_size);
+    }
+    close(client->fd);
+    free(client);
+}
+
+/* Coroutine entry: the whole game, exactly as played on a local terminal. */
+static void host_client_main_(void)
+{
+    borrowed host_client_t * client = _starting;
+    borrowed rps_session_t * s      = &client->session;
+
+    if (rps_session_start(s, false))
+    {
+        rps_session_run(s);
+        rps_session_stop(s);
+    }
+
+    /* still on the coroutine: the goodbye may have to wait for the socket to drain */
+    rps_session_fin(s);
+    client->done = true;
+}
+
+/* terminal_wait_fn of hosted sessions: parks the coroutine until epoll or the deadline
+ * resumes it, then reports readiness like poll() would. */
+static copied int host_client_wait_(borrowed void * context, borrowed struct pollfd * fds, copied int count, copied int timeout_ms)
+{
+    borrowed host_client_t * client = context;
+    borrowed host_loop_t   * loop   = client->loop;
+
+    if (timeout_ms == 0)
+    {
+        return poll(fds, cast(count, nfds_t), 0);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        copied struct epoll_event event = {
+            .events   = ((fds[i].events & POLLIN) ? EPOLLIN : 0) | ((fds[i].events & POLLOUT) ? EPOLLOUT : 0),
+            .data.ptr = client,
+        };
+        epoll_ctl(loop->epoll, EPOLL_CTL_ADD, fds[i].fd, &event);
+    }
+    client->deadline = (timeout_ms < 0) ? 0 : monotonic_ns() + cast(timeout_ms, uint64_t) * NSEC_PER_MSEC;
+
+    copied int ready = 0;
+    do
+    {
+        client->waiting = true;
+        swapcontext(&client->context, &loop->context);
+
+        /* events for an earlier wait may still resume us: only the deadline means timeout */
+        ready = poll(fds, cast(count, nfds_t), 0);
+    } while (ready == 0 && (client->deadline == 0 || monotonic_ns() < client->deadline));
+
+    for (int i = 0; i < count; i++)
+    {
+        epoll_ctl(loop->epoll, EPOLL_CTL_DEL, fds[i].fd, nil);
+    }
+    client->deadline = 0;
+    return ready;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied int host_listen_(borrowed const char * path)
+{
+    copied struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    copied int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    unlink(path);
+    if (bind(fd, cast(&addr, struct sockaddr *), sizeof(addr)) < 0 || listen(fd, HOST_BACKLOG) < 0)
+    {
+        copied int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
@@ -2,41 +2,39 @@
 
 #include <stdio.h>
 #include <unistd.h>
-#include <termios.h>
 #include <string.h>
 
 #include "terminal.h"
+#include "metrics.h"
 
 #define ESC                 (0x1b)
-#define ESC_TIMEOUT_DS      (1) /* deciseconds (100ms) */
+#define ESC_TIMEOUT_MS      (100)   /* wait for the rest of an escape sequence */
 
-static bool _timeout_enabled = false;
-
-static copied key_t keyboard_key_event_esc();
+static copied key_t keyboard_key_event_esc(borrowed terminal_t * term);
 static copied key_t keyboard_key_event_ctrl(copied const key_t key);
 static copied key_t keyboard_key_event_ctrl_alt(copied const key_t key);
-static copied key_t keyboard_key_event_csi();
-static copied key_t keyboard_key_event_csi_ext(copied const key_t key);
-static copied key_t keyboard_key_event_ss3();
+static copied key_t keyboard_key_event_csi(borrowed terminal_t * term);
+static copied key_t keyboard_key_event_csi_ext(borrowed terminal_t * term, copied const key_t key);
+static copied key_t keyboard_key_event_ss3(borrowed terminal_t * term);
+static copied key_t keyboard_key_event_read(borrowed terminal_t * term);
+static copied metric_t keyboard_key_event_metric(copied const key_t key);
 
-static copied key_t keyboard_key_event_csi_ext(copied const key_t key)
+static copied key_t keyboard_key_event_csi_ext(borrowed terminal_t * term, copied const key_t key)
 {
     copied int32_t n = key - '0';
 
-    copied int32_t b = terminal_raw_byte_read();
+    copied int32_t b = terminal_raw_byte_read_timeout(term, ESC_TIMEOUT_MS);
     if (b == -1)
     {
-        keyboard_event_timeout_disable();
         return key_unknown;
     }
 
     if ('0' <= b && b <= '9')
     {
         n = (n * 10) + (b - '0');
-        b = terminal_raw_byte_read();
+        b = terminal_raw_byte_read_timeout(term, ESC_TIMEOUT_MS);
     }
 
-    keyboard_event_timeout_disable();
     if (b != '~')
     {
         return key_unknown;
@@ -68,44 +66,38 @@ static copied key_t keyboard_key_event_csi_ext(copied const key_t key)
     }
 }
 
-static copied key_t keyboard_key_event_csi()
+static copied key_t keyboard_key_event_csi(borrowed terminal_t * term)
 {
-    copied int32_t b = terminal_raw_byte_read();
+    copied int32_t b = terminal_raw_byte_read_timeout(term, ESC_TIMEOUT_MS);
     switch (b)
     {
         case 'A':
         {
-            keyboard_event_timeout_disable();
             return key_up;
         } break;
 
         case 'B':
         {
-            keyboard_event_timeout_disable();
             return key_down;
         } break;
 
         case 'C':
         {
-            keyboard_event_timeout_disable();
             return key_right;
         } break;
 
         case 'D':
         {
-            keyboard_event_timeout_disable();
             return key_left;
         } break;
 
         case 'H':
         {
-            keyboard_event_timeout_disable();
             return key_home;
         } break;
 
         case 'F':
         {
-            keyboard_event_timeout_disable();
             return key_end;
         } break;
 
@@ -120,21 +112,19 @@ static copied key_t keyboard_key_event_csi()
         case '8':
         case '9':
         {
-            return keyboard_key_event_csi_ext(b);
+            return keyboard_key_event_csi_ext(term, b);
         } break;
 
         default:
         {
-            keyboard_event_timeout_disable();
             return key_none;
         } break;
     }
 }
 
-static copied key_t keyboard_key_event_ss3()
+static copied key_t keyboard_key_event_ss3(borrowed terminal_t * term)
 {
-    copied int32_t key = terminal_raw_byte_read();
-    keyboard_event_timeout_disable();
+    copied int32_t key = terminal_raw_byte_read_timeout(term, ESC_TIMEOUT_MS);
     switch (key)
     {
         case 'P': return key_f1     ;
@@ -152,21 +142,18 @@ static copied key_t keyboard_key_event_ss3()
     }
 }
 
-static copied key_t keyboard_key_event_esc()
+static copied key_t keyboard_key_event_esc(borrowed terminal_t * term)
 {
-    keyboard_event_timeout_enable();
 
-    copied int32_t b = terminal_raw_byte_read();
+    copied int32_t b = terminal_raw_byte_read_timeout(term, ESC_TIMEOUT_MS);
     if (b == -1)
     {
-        keyboard_event_timeout_disable();
         return key_esc;
     }
 
     // alt + <key>
     if (0x20 <= b && b < 0x7f && b != '[' && b != 'O')
     {
-        keyboard_event_timeout_disable();
         return (alt_mask | b);
     }
 
@@ -179,22 +166,20 @@ static copied key_t keyboard_key_event_esc()
     // CSI
     if (b == '[')
     {
-        return keyboard_key_event_csi();
+        return keyboard_key_event_csi(term);
     }
 
     // SS3
     if (b == 'O')
     {
-        return keyboard_key_event_ss3();
+        return keyboard_key_event_ss3(term);
     }
 
-    keyboard_event_timeout_disable();
     return key_unknown;
 }
 
 static copied key_t keyboard_key_event_ctrl_alt(copied const key_t key)
 {
-    keyboard_event_timeout_disable();
     if (key == key_tab || key == key_enter)
     {
         return key;
@@ -211,9 +196,49 @@ static copied key_t keyboard_key_event_ctrl(copied const key_t key)
     return (ctrl_mask | (key - 1 + 'a'));
 }
 
-copied key_t keyboard_key_event()
+copied key_t keyboard_key_event(borrowed terminal_t * term)
+{
+    copied key_t key = keyboard_key_event_read(term);
+    if (key != key_none)
+    {
+        metrics_add(keyboard_key_event_metric(key), 1);
+    }
+    return key;
+}
+
+static copied metric_t keyboard_key_event_metric(copied const key_t key)
 {
-    int32_t b = terminal_raw_byte_read();
+    copied key_t base = baseof(key);
+    if (key == key_unknown)
+    {
+        return metric_keys_unknown;
+    }
+    if (key & alt_mask)
+    {
+        return metric_keys_alt;
+    }
+    if (key & ctrl_mask)
+    {
+        return metric_keys_control;
+    }
+    if (base == key_enter || base == key_tab || base == key_backspace || base == key_esc)
+    {
+        return metric_keys_editing;
+    }
+    if (key_up <= base && base <= key_delete)
+    {
+        return metric_keys_navigation;
+    }
+    if (key_f1 <= base && base <= key_f12)
+    {
+        return metric_keys_function;
+    }
+    return (base < key_esc) ? metric_keys_text : metric_keys_unknown;
+}
+
+static copied key_t keyboard_key_event_read(borrowed terminal_t * term)
+{
+    int32_t b = terminal_raw_byte_read(term);
     if (b == -1)
     {
         return key_none;
@@ -221,7 +246,7 @@ copied key_t keyboard_key_event()
 
     if (b == ESC)
     {
-        return keyboard_key_event_esc();
+        return keyboard_key_event_esc(term);
     }
 
     if (0x01 <= b && b <= 0x1a)
@@ -232,14 +257,11 @@ copied key_t keyboard_key_event()
     return cast(b, key_t);
 }
 
-// NOTE: this function is NOT thread-safe, use it only in single-thread situation.
-borrowed const char * keyboard_key_event_name_map(copied const key_t key)
+borrowed const char * keyboard_key_event_name_map(copied const key_t key, borrowed char * keyname, copied size_t size)
 {
     if (key == key_unknown) return "<UNKNOWN>";
     if (key == key_none)    return "<NONE>";
 
-    static copied char keyname[64] = { 0 };
-
     copied char meta[7] = { 0 };
     if (key & ctrl_mask)
     {
@@ -292,60 +314,18 @@ borrowed const char * keyboard_key_event_name_map(copied const key_t key)
 
     if (name)
     {
-        snprintf(keyname, sizeof(keyname), "%s%s", meta, name);
+        snprintf(keyname, size, "%s%s", meta, name);
     }
     else if (0x20 <= base && base < 0x7f)
     {
         /* printable ASCII */
-        snprintf(keyname, sizeof(keyname), "%s'%c'", meta, (char) base);
+        snprintf(keyname, size, "%s'%c'", meta, (char) base);
     }
     else
     {
         /* non-printable */
-        snprintf(keyname, sizeof(keyname), "%s0x%02X", meta, base);
+        snprintf(keyname, size, "%s0x%02X", meta, base);
     }
 
     return keyname;
 }
-
-void keyboard_event_timeout_enable()
-{
-    if (_timeout_enabled)
-    {
-        return;
-    }
-
-    struct termios term;
-    tcgetattr(STDIN_FILENO, &term);
-    term.c_cc[VMIN]  = 0;
-    term.c_cc[VTIME] = ESC_TIMEOUT_DS;
-    tcsetattr(STDIN_FILENO, TCSANOW, &term);
-    _timeout_enabled = true;
-}
-
-void keyboard_event_timeout_disable()
-{
-    if (!_timeout_enabled)
-    {
-        return;
-    }
-
-    struct termios term;
-    tcgetattr(STDIN_FILENO, &term);
-    term.c_cc[VMIN]  = 1;
-    term.c_cc[VTIME] = 0;
-    tcsetattr(STDIN_FILENO, TCSANOW, &term);
-    _timeout_enabled = false;
-}
-
-void keyboard_event_timeout_toggle()
-{
-    if (_timeout_enabled)
-    {
-        keyboard_event_timeout_disable();
-    }
-    else
-    {
-        keyboard_event_timeout_enable();
-    }
-}
@@ -0,0 +1,238 @@
+#include "layout.h"
+
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "terminal.h"
+
+#define CLEAR_LINE          "\x1b[2K"
+
+#define HEADER_HEIGHT       (2)
+#define PICKER_HEIGHT       (3)
+#define RESULT_HEIGHT       (4)
+#define STATUS_HEIGHT       (1)
+#define SCOREBOARD_HEIGHT   (1)
+#define REGION_GAP          (1)
+#define LAYOUT_MAX_HEIGHT   (4)                 /* tallest region */
+
+#define DEFAULT_ROWS        (24)
+#define DEFAULT_COLS        (80)
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Module State
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/* bumped by every SIGWINCH, each layout compares it with the count it last saw */
+static volatile sig_atomic_t _resizes = 0;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void layout_query_size_(borrowed layout_t * layout);
+static void layout_compute_(borrowed const layout_t * layout, borrowed region_t * regions);
+static void layout_clear_(borrowed layout_t * layout, borrowed const region_t * region);
+static void layout_sigwinch_handler_(copied int sig);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void layout_init(borrowed layout_t * layout, borrowed terminal_t * term, borrowed region_paint_fn * paint, borrowed void * context)
+{
+    memset(layout, 0, sizeof(*layout));
+    layout->term    = term;
+    layout->paint   = paint;
+    layout->context = context;
+    layout->resizes = _resizes;
+    layout_query_size_(layout);
+    layout_compute_(layout, layout->regions);
+
+    for (int i = 0; i < region_count; i++)
+    {
+        layout->dirty[i] = true;
+    }
+
+    /* no SA_RESTART: a resize interrupts the blocking key read so the UI reacts at once */
+    copied struct sigaction sa = { 0 };
+    sa.sa_handler = layout_sigwinch_handler_;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;
+    sigaction(SIGWINCH, &sa, nil);
+}
+
+borrowed const region_t * layout_region(borrowed const layout_t * layout, copied region_id_t id)
+{
+    return &layout->regions[id];
+}
+
+void layout_invalidate(borrowed layout_t * layout, copied region_id_t id)
+{
+    layout->dirty[id] = true;
+}
+
+void layout_render(borrowed layout_t * layout)
+{
+    for (int i = 0; i < region_count; i++)
+    {
+        if (!layout->dirty[i])
+        {
+            continue;
+        }
+        layout->dirty[i] = false;
+
+        layout_clear_(layout, &layout->regions[i]);
+        if (layout->paint)
+        {
+            layout->paint(layout->context, cast(i, region_id_t), &layout->regions[i]);
+        }
+    }
+}
+
+copied bool layout_refresh(borrowed layout_t * layout)
+{
+    if (layout->resizes == _resizes)
+    {
+        return false;
+    }
+    layout->resizes = _resizes;
+
+    layout_query_size_(layout);
+
+    copied region_t next[region_count];
+    layout_compute_(layout, next);
+
+    for (int i = 0; i < region_count; i++)
+    {
+        copied region_t * current = &layout->regions[i];
+        copied bool       moved   = next[i].row != current->row || next[i].col != current->col
+                                 || next[i].height != current->height;
+
+        /* a narrower region is clipped by the terminal itself, only a wider one shows more */
+        if (!moved && next[i].width <= current->width)
+        {
+            *current = next[i];
+            continue;
+        }
+
+        /* wipe where the region used to be, unless that is off screen now */
+        if (moved && current->row < layout->rows)
+        {
+            layout_clear_(layout, current);
+        }
+        *current         = next[i];
+        layout->dirty[i] = true;
+    }
+
+    /* a moved region may have been wiped over a neighbour that stayed put */
+    for (int i = 0; i < region_count; i++)
+    {
+        for (int j = 0; j < region_count; j++)
+        {
+            copied const region_t * a = &layout->regions[i];
+            copied const region_t * b = &layout->regions[j];
+            if (i != j && layout->dirty[j] && !layout->dirty[i] &&
+                a->row < b->row + b->height && b->row < a->row + a->height)
+            {
+                layout->dirty[i] = true;
+            }
+        }
+    }
+
+    layout_render(layout);
+    return true;
+}
+
+copied size_t layout_goto(borrowed char * buf, copied uint16_t row, copied uint16_t col)
+{
+    /* CUP is 1-based: ESC [ row ; col H */
+    copied uint32_t values[2] = { cast(row, uint32_t) + 1, cast(col, uint32_t) + 1 };
+    copied size_t   len = 0;
+
+    buf[len++] = '\x1b';
+    buf[len++] = '[';
+    for (int v = 0; v < 2; v++)
+    {
+        copied char   digits[5];
+        copied size_t count = 0;
+        do
+        {
+            digits[count++] = cast('0' + (values[v] % 10), char);
+            values[v] /= 10;
+        } while (values[v] > 0);
+
+        while (count > 0)
+        {
+            buf[len++] = digits[--count];
+        }
+        buf[len++] = (v == 0) ? ';' : 'H';
+    }
+    return len;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Geometry
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void layout_query_size_(borrowed layout_t * layout)
+{
+    copied struct winsize ws = { 0 };
+    if (ioctl(layout->term->out, TIOCGWINSZ, &ws) < 0 || ws.ws_row == 0 || ws.ws_col == 0)
+    {
+        ws.ws_row = DEFAULT_ROWS;
+        ws.ws_col = DEFAULT_COLS;
+    }
+    layout->rows = ws.ws_row;
+    layout->cols = ws.ws_col;
+}
+
+/*
+ * Header, picker, result and status stack from the top; the scoreboard sticks to the
+ * bottom row, or right below the status line when the terminal is too short.
+ */
+static void layout_compute_(borrowed const layout_t * layout, borrowed region_t * regions)
+{
+    copied uint16_t row = 0;
+
+    regions[region_header] = (region_t) { .row = row, .col = 0, .height = HEADER_HEIGHT, .width = layout->cols };
+    row += HEADER_HEIGHT + REGION_GAP;
+
+    regions[region_picker] = (region_t) { .row = row, .col = 0, .height = PICKER_HEIGHT, .width = layout->cols };
+    row += PICKER_HEIGHT + REGION_GAP;
+
+    regions[region_result] = (region_t) { .row = row, .col = 0, .height = RESULT_HEIGHT, .width = layout->cols };
+    row += RESULT_HEIGHT + REGION_GAP;
+
+    regions[region_status] = (region_t) { .row = row, .col = 0, .height = STATUS_HEIGHT, .width = layout->cols };
+    row += STATUS_HEIGHT + REGION_GAP;
+
+    copied uint16_t bottom = (layout->rows > SCOREBOARD_HEIGHT) ? layout->rows - SCOREBOARD_HEIGHT : 0;
+    regions[region_scoreboard] = (region_t) {
+        .row    = (bottom > row) ? bottom : row,
+        .col    = 0,
+        .height = SCOREBOARD_HEIGHT,
+        .width  = layout->cols,
+    };
+}
+
+static void layout_clear_(borrowed layout_t * layout, borrowed const region_t * region)
+{
+    copied char         seq[LAYOUT_MAX_HEIGHT][16];
+    copied struct iovec iov[LAYOUT_MAX_HEIGHT * 2];
+    copied int          n = 0;
+
+    for (uint16_t r = 0; r < region->height && r < LAYOUT_MAX_HEIGHT; r++)
+    {
+        iov[n++] = (struct iovec) { .iov_base = seq[r], .iov_len = layout_goto(seq[r], region->row + r, region->col) };
+        iov[n++] = (struct iovec) { .iov_base = CLEAR_LINE, .iov_len = sizeof(CLEAR_LINE) - 1 };
+    }
+    terminal_writev(layout->term, iov, n);
+}
+
+static void layout_sigwinch_handler_(copied int sig)
+{
+    (void) sig;
+    _resizes = _resizes + 1;
+}
@@ -0,0 +1,223 @@
+#include "leaderboard.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "game.h"
+#include "profile.h"
+#include "rating.h"
+#include "roundlog.h"
+
+#define LEADERBOARD_PATH_MAX    (4096)
+#define LEADERBOARD_RECORDS     (8192)      /* records read, and games rated, per batch */
+
+/* One replay: a read buffer, the games made from it, and a name for every rated slot */
+typedef struct {
+    copied roundlog_record_t records[LEADERBOARD_RECORDS];
+    copied rating_game_t     games[LEADERBOARD_RECORDS];
+    copied rating_table_t    table;
+    owned  char           (* names)[ROUNDLOG_NAME_MAX + 1];
+    copied uint32_t          named;
+    copied uint64_t          rounds;
+} leaderboard_t;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool leaderboard_replay_(borrowed leaderboard_t * board, copied int fd, borrowed const char * path);
+static copied bool leaderboard_rate_(borrowed leaderboard_t * board, copied size_t count);
+static copied bool leaderboard_name_(borrowed leaderboard_t * board, copied uint64_t id, borrowed const char * name, copied size_t len);
+static void        leaderboard_report_(borrowed leaderboard_t * board, copied uint32_t top);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool leaderboard_print(copied uint32_t top)
+{
+    copied char path[LEADERBOARD_PATH_MAX];
+    if (!roundlog_path(path, sizeof(path)))
+    {
+        fprintf(stderr, "rps: no round log (set " ROUNDLOG_ENV " or HOME)\n");
+        return false;
+    }
+
+    owned leaderboard_t * board = calloc(1, sizeof(leaderboard_t));
+    if (!board || !rating_init(&board->table, 64))
+    {
+        fprintf(stderr, "rps: out of memory\n");
+        free(board);
+        return false;
+    }
+
+    copied bool ok = leaderboard_name_(board, rating_id(PROFILE_PLAYER), PROFILE_PLAYER, sizeof(PROFILE_PLAYER) - 1);
+    copied int  fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        ok = ok && leaderboard_replay_(board, fd, path);
+        close(fd);
+    }
+    else if (errno != ENOENT)
+    {
+        /* nothing played yet is an empty board, not an error */
+        perror(path);
+        ok = false;
+    }
+
+    if (ok)
+    {
+        leaderboard_report_(board, top);
+    }
+    rating_free(&board->table);
+    free(board->names);
+    free(board);
+    return ok;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool leaderboard_replay_(borrowed leaderboard_t * board, copied int fd, borrowed const char * path)
+{
+    if (!roundlog_read_header(fd))
+    {
+        fprintf(stderr, "rps: %s is not a round log\n", path);
+        return false;
+    }
+
+    /* bytes of a record split across two reads carry over to the front of the buffer */
+    copied size_t pending = 0;
+    for (;;)
+    {
+        copied ssize_t n = read(fd, cast(board->records, char *) + pending, sizeof(board->records) - pending);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            perror(path);
+            return false;
+        }
+        if (n == 0)
+        {
+            return true;    /* a torn record at the very end is dropped */
+        }
+
+        copied size_t bytes = pending + cast(n, size_t);
+        copied size_t count = bytes / sizeof(roundlog_record_t);
+        if (!leaderboard_rate_(board, count))
+        {
+            fprintf(stderr, "rps: out of memory\n");
+            return false;
+        }
+
+        pending = bytes - count * sizeof(roundlog_record_t);
+        memmove(board->records, &board->records[count], pending);
+    }
+}
+
+/* Turns the first `count` records into games and rates them as one batch. */
+static copied bool leaderboard_rate_(borrowed leaderboard_t * board, copied size_t count)
+{
+    static const f32 scores[3] = { [result_draw] = 0.5f, [result_win] = 1.0f, [result_lose] = 0.0f };
+    copied uint64_t player = rating_id(PROFILE_PLAYER);
+
+    /* the same opponent plays long runs of rounds, hash its name once per run */
+    copied char     last[ROUNDLOG_NAME_MAX] = { 0 };
+    copied uint64_t id    = 0;
+    copied size_t   games = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        borrowed const roundlog_record_t * record = &board->records[i];
+        if (record->result >= 3)
+        {
+            continue;
+        }
+
+        if (i == 0 || 0 != memcmp(record->strategy, last, ROUNDLOG_NAME_MAX))
+        {
+            copied char   name[ROUNDLOG_NAME_MAX + 1];
+            copied size_t len = strnlen(record->strategy, ROUNDLOG_NAME_MAX);
+            memcpy(name, record->strategy, len);
+            name[len] = '\0';
+            memcpy(last, record->strategy, ROUNDLOG_NAME_MAX);
+
+            id = rating_id(name);
+            if (!leaderboard_name_(board, id, name, len))
+            {
+                return false;
+            }
+        }
+        board->games[games++] = (rating_game_t) { .player = player, .opponent = id, .score = scores[record->result] };
+    }
+
+    board->rounds += games;
+    return rating_update_batch(&board->table, board->games, games);
+}
+
+/* Adds `id` to the table under `name` unless it is there already. */
+static copied bool leaderboard_name_(borrowed leaderboard_t * board, copied uint64_t id, borrowed const char * name, copied size_t len)
+{
+    if (rating_find(&board->table, id) >= 0)
+    {
+        return true;
+    }
+
+    copied int64_t slot = rating_add(&board->table, id, RATING_INITIAL, RATING_DEVIATION, 0);
+    if (slot < 0)
+    {
+        return false;
+    }
+
+    /* slots are handed out in order, so names grow alongside */
+    if (board->named <= cast(slot, uint32_t))
+    {
+        copied uint32_t named = board->named ? 2 * board->named : 64;
+        owned    void * names = realloc(board->names, named * sizeof(*board->names));
+        if (!names)
+        {
+            return false;
+        }
+        board->names = names;
+        board->named = named;
+    }
+    memcpy(board->names[slot], name, len);
+    board->names[slot][len] = '\0';
+    return true;
+}
+
+static void leaderboard_report_(borrowed leaderboard_t * board, copied uint32_t top)
+{
+    if (top > board->table.count)
+    {
+        top = board->table.count;
+    }
+
+    owned uint32_t * slots = malloc((top ? top : 1) * sizeof(uint32_t));
+    if (!slots)
+    {
+        fprintf(stderr, "rps: out of memory\n");
+        return;
+    }
+
+    copied uint32_t shown = rating_top(&board->table, top, slots);
+    printf("players:       %u\n", board->table.count);
+    printf("rounds:        %llu\n", cast(board->rounds, unsigned long long));
+    printf("\n%4s  %-16s  %7s  %9s  %10s  %10s\n", "rank", "name", "rating", "deviation", "games", "percentile");
+    for (uint32_t i = 0; i < shown; i++)
+    {
+        copied uint32_t slot = slots[i];
+        printf("%4u  %-16s  %7.1f  %9.1f  %10u  %9.1f%%\n",
+               i + 1, board->names[slot], board->table.ratings[slot], board->table.deviations[slot],
+               board->table.games[slot], 100.0f * rating_percentile(&board->table, slot));
+    }
+    free(slots);
+}
@@ -0,0 +1,160 @@
+#include "librps.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "strategy.h"
+#include "bandit.h"
+
+#define MATCH_CHUNK     (4096)      /* rounds judged per pass through the scratch buffers */
+
+_Static_assert(RPS_MOVE_ROCK == move_rock && RPS_MOVE_PAPER == move_paper && RPS_MOVE_SCISSORS == move_scissors, "librps moves must match move_t");
+_Static_assert(RPS_RESULT_DRAW == result_draw && RPS_RESULT_WIN == result_win && RPS_RESULT_LOSE == result_lose, "librps results must match result_t");
+
+struct rps_match {
+    copied strategy_t opponent;
+    copied bot_t      bot;
+    copied history_t  history;
+    copied uint64_t   tally[3];
+
+    /* scratch, so that playing never allocates */
+    copied uint8_t    computer[MATCH_CHUNK];
+    copied uint8_t    results[MATCH_CHUNK];
+};
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied uint32_t match_valid_prefix_(borrowed const uint8_t * player, copied uint32_t n);
+static void            match_play_chunk_(borrowed rps_match_t * match, borrowed const uint8_t * player, copied uint32_t n);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Lifecycle
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+uint32_t rps_version(void)
+{
+    return RPS_API_VERSION;
+}
+
+rps_match_t * rps_match_create(const rps_match_config_t * config, const char ** error)
+{
+    borrowed const char * ignored = nil;
+    if (!error)
+    {
+        error = &ignored;
+    }
+
+    owned rps_match_t * match = calloc(1, sizeof(*match));
+    if (!match || !history_init(&match->history, HISTORY_WINDOW))
+    {
+        free(match);
+        *error = "out of memory";
+        return nil;
+    }
+
+    copied strategy_spec_t spec = {
+        .name            = config->opponent ? config->opponent : "random",
+        .bot_path        = config->bot_path,
+        .table_path      = config->table_path,
+        .seed            = config->seed,
+        .target_win_rate = config->target_win_rate > 0.0f ? config->target_win_rate : BANDIT_TARGET,
+    };
+    if (!strategy_load(&match->opponent, &match->bot, &spec, error))
+    {
+        rps_match_destroy(match);
+        return nil;
+    }
+    return match;
+}
+
+void rps_match_destroy(rps_match_t * match)
+{
+    if (!match)
+    {
+        return;
+    }
+    strategy_destroy(&match->opponent);
+    bot_unload(&match->bot);
+    history_free(&match->history);
+    free(match);
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Playing
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+uint32_t rps_match_play_n(rps_match_t * match, const uint8_t * player, uint32_t n, uint8_t * computer, uint8_t * results)
+{
+    n = match_valid_prefix_(player, n);
+    for (uint32_t done = 0; done < n; )
+    {
+        copied uint32_t chunk = (n - done < MATCH_CHUNK) ? n - done : MATCH_CHUNK;
+        match_play_chunk_(match, player + done, chunk);
+        if (computer)
+        {
+            memcpy(computer + done, match->computer, chunk);
+        }
+        if (results)
+        {
+            memcpy(results + done, match->results, chunk);
+        }
+        done += chunk;
+    }
+    return n;
+}
+
+uint64_t rps_match_rounds(const rps_match_t * match, uint64_t tally[3])
+{
+    if (tally)
+    {
+        memcpy(tally, match->tally, sizeof(match->tally));
+    }
+    return match->history.total;
+}
+
+void rps_judge_n(const uint8_t * a, const uint8_t * b, uint32_t n, uint8_t * results)
+{
+    judge_n(a, b, n, results);
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied uint32_t match_valid_prefix_(borrowed const uint8_t * player, copied uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (player[i] >= moves_count)
+        {
+            return i;
+        }
+    }
+    return n;
+}
+
+/* Plays up to MATCH_CHUNK rounds into the scratch buffers, committing `batch` moves at a time. */
+static void match_play_chunk_(borrowed rps_match_t * match, borrowed const uint8_t * player, copied uint32_t n)
+{
+    borrowed strategy_t * opponent = &match->opponent;
+    for (uint32_t done = 0; done < n; )
+    {
+        copied uint32_t run = (n - done < opponent->batch) ? n - done : opponent->batch;
+        strategy_choose_n(opponent, &match->history, run, match->computer + done);
+        for (uint32_t i = done; i < done + run; i++)
+        {
+            history_push(&match->history, cast(player[i], move_t), cast(match->computer[i], move_t));
+            strategy_observe(opponent, cast(player[i], move_t), cast(match->computer[i], move_t));
+        }
+        done += run;
+    }
+
+    judge_n(player, match->computer, n, match->results);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        match->tally[match->results[i]]++;
+    }
+}
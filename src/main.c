@@ -1,221 +1,506 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "rps.h"
-#include "terminal.h"
-#include "keys.h"
-#include "crayon.h"
-
-#define loop for(;;)
-
-typedef enum {
-    move_rock     = 0,
-    move_paper    = 1,
-    move_scissors = 2,
-} move_t;
-
-typedef enum {
-    result_draw = 0,
-    result_win  = 1,
-    result_lose = 2,
-} result_t;
-
-/* Player's chosen styles */
-static int8_t rock_style    = 0;
-static int8_t paper_style   = 0;
-static int8_t scissor_style = 0;
-
-int8_t choose_item(borrowed const char * prompt, borrowed const char * const * items, copied const int8_t count)
+#include "rng.h"
+#include "bandit.h"
+#include "session.h"
+#include "simulate.h"
+#include "protocol.h"
+#include "host.h"
+#include "shard.h"
+#include "export.h"
+#include "leaderboard.h"
+#include "evolve.h"
+#include "evaluate.h"
+#include "tuning.h"
+#include "metrics.h"
+#include "table.h"
+
+void usage(borrowed const char * prog)
 {
-    int8_t idx = 0;
-    loop
+    fprintf(stderr, "usage: %s [--choose-styles] [--opponent NAME | --bot PATH | --table PATH | --duel NAME] [--simulate ROUNDS [--perf-counters | --shards K [--checkpoint PATH]] | --bot-protocol | --host PATH] [--broadcast PATH] [--record PATH] [--no-animation] [--seed N] [--target-win-rate P] [--tuning PATH] [--metrics PATH|PORT]\n", prog);
+    fprintf(stderr, "       %s export --format csv|jsonl\n", prog);
+    fprintf(stderr, "       %s ratings [--top K]\n", prog);
+    fprintf(stderr, "       %s evolve --out PATH [--population N] [--generations N] [--rounds N] [--threads N] [--seed N] [--perf-counters]\n", prog);
+    fprintf(stderr, "       %s evaluate [--opponent NAME | --bot PATH | --table PATH] [--player NAME | --player-table PATH] [--noise P] [--rounds N] [--seed N] [--target-win-rate P]\n", prog);
+    fprintf(stderr, "  --choose-styles       pick emoji styles again instead of using the saved ones\n");
+    fprintf(stderr, "  --opponent NAME       built-in computer strategy: " STRATEGY_NAMES " (default: random)\n");
+    fprintf(stderr, "  --bot PATH            play against the bot plugin at PATH (see rps_bot.h)\n");
+    fprintf(stderr, "  --table PATH          play against a lookup table written by `rps evolve`\n");
+    fprintf(stderr, "  --duel NAME           play another local rps process started with the same NAME\n");
+    fprintf(stderr, "  --simulate ROUNDS     play ROUNDS random moves against the opponent and print the tally\n");
+    fprintf(stderr, "  --shards K            split --simulate over K worker processes, each with its own opponent\n");
+    fprintf(stderr, "  --checkpoint PATH     keep the shards' progress in PATH and resume from it when run again\n");
+    fprintf(stderr, "  --perf-counters       with --simulate or evolve, report CPU cycles, IPC and branch / cache misses per round\n");
+    fprintf(stderr, "  --bot-protocol        play moves piped to stdin, answering on stdout (see protocol.h)\n");
+    fprintf(stderr, "  --host PATH           serve the game to any number of terminals connecting to the Unix socket PATH\n");
+    fprintf(stderr, "  --broadcast PATH      stream every round to spectators connecting to the Unix socket PATH\n");
+    fprintf(stderr, "  --record PATH         record the session to PATH as an asciicast v2 file (asciinema play PATH)\n");
+    fprintf(stderr, "  --no-animation        show results at once, without the countdown and reveal\n");
+    fprintf(stderr, "  --seed N              seed the computer's moves, so a match can be replayed\n");
+    fprintf(stderr, "  --target-win-rate P   player win rate the adaptive opponent steers towards, draws count half (default: 0.45)\n");
+    fprintf(stderr, "  --tuning PATH         read opponent tuning from PATH and reload it whenever it changes (see tuning.h)\n");
+    fprintf(stderr, "  --metrics PATH|PORT   serve live counters in the Prometheus text format on a Unix socket or 127.0.0.1:PORT\n");
+    fprintf(stderr, "  export                write every recorded round to stdout (log: $" ROUNDLOG_ENV " or ~/" ROUNDLOG_FILENAME ")\n");
+    fprintf(stderr, "  ratings               rate everyone in the round log and list the best K (default: %d) with their percentiles\n", LEADERBOARD_TOP);
+    fprintf(stderr, "  evolve                breed a lookup-table opponent with a genetic algorithm and save the fittest\n");
+    fprintf(stderr, "  evaluate              long-run win, draw and loss rates of a player (random, " TABLE_REFERENCE_NAMES ",\n");
+    fprintf(stderr, "                        or a table) against the opponent, exact for finite-memory opponents, simulated otherwise\n");
+}
+
+/* rps export --format csv|jsonl */
+int export_main(int argc, char ** argv)
+{
+    copied export_format_t format = export_csv;
+    for (int i = 2; i < argc; i++)
     {
-        printf("%s", prompt);
-        for (int8_t i = 0; i < count; i++)
+        if (0 == strcmp(argv[i], "--format") && i + 1 < argc && export_format_parse(argv[i + 1], &format))
         {
-            if (i == idx)
-            {
-                printf(CRAYON_TO_REVERSED("%s"), items[i]);
-            }
-            else
+            i++;
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    return export_rounds(format, STDOUT_FILENO) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* rps ratings [--top K] */
+int ratings_main(int argc, char ** argv)
+{
+    copied uint32_t top = LEADERBOARD_TOP;
+    for (int i = 2; i < argc; i++)
+    {
+        borrowed char * end = nil;
+        if (0 == strcmp(argv[i], "--top") && i + 1 < argc)
+        {
+            copied unsigned long k = strtoul(argv[++i], &end, 10);
+            if (*end != '\0' || k == 0 || k > UINT32_MAX)
             {
-                printf("%s", items[i]);
+                usage(argv[0]);
+                return EXIT_FAILURE;
             }
+            top = cast(k, uint32_t);
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    return leaderboard_print(top) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* rps evolve --out PATH [--population N] [--generations N] [--rounds N] [--threads N] [--seed N] [--perf-counters] */
+int evolve_main(int argc, char ** argv)
+{
+    copied evolve_config_t config = {
+        .population  = EVOLVE_POPULATION,
+        .generations = EVOLVE_GENERATIONS,
+        .rounds      = EVOLVE_ROUNDS,
+        .threads     = 0,
+        .seed        = rng_entropy(),
+        .out         = nil,
+    };
+    for (int i = 2; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "--perf-counters"))
+        {
+            config.perf_counters = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
         }
-        fflush(stdout);
 
-        copied key_t key = keyboard_key_event();
-        if (key == key_left && idx > 0)
+        borrowed const char * value = argv[i + 1];
+        if (0 == strcmp(argv[i], "--out"))
+        {
+            config.out = value;
+        }
+        else if (0 == strcmp(argv[i], "--population"))
+        {
+            config.population = cast(strtoul(value, nil, 10), uint32_t);
+        }
+        else if (0 == strcmp(argv[i], "--generations"))
+        {
+            config.generations = cast(strtoul(value, nil, 10), uint32_t);
+        }
+        else if (0 == strcmp(argv[i], "--rounds"))
         {
-            idx--;
+            config.rounds = cast(strtoul(value, nil, 10), uint32_t);
         }
-        else if (key == key_right && idx < count - 1)
+        else if (0 == strcmp(argv[i], "--threads"))
         {
-            idx++;
+            config.threads = cast(strtoul(value, nil, 10), uint32_t);
         }
-        else if (key == key_enter)
+        else if (0 == strcmp(argv[i], "--seed"))
         {
-            printf("\r\n");
-            return idx;
+            config.seed = strtoull(value, nil, 10);
         }
-        else if (key == (ctrl_mask | 'q'))
+        else
         {
-            printf("\r\n");
-            exit(EXIT_SUCCESS);
+            usage(argv[0]);
+            return EXIT_FAILURE;
         }
+        i++;
+    }
 
-        printf("\r");
+    if (!config.out || config.population == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
     }
+    return evolve(&config) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-borrowed const char * get_move_emoji(copied move_t move)
+/* rps evaluate [--opponent NAME | --bot PATH | --table PATH] [--player NAME | --player-table PATH] [--noise P] [--rounds N] [--seed N] [--target-win-rate P] */
+int evaluate_main(int argc, char ** argv)
 {
-    switch (move)
+    copied evaluate_config_t config = {
+        .opponent = {
+            .name            = "random",
+            .seed            = rng_entropy(),
+            .target_win_rate = BANDIT_TARGET,
+        },
+        .player   = "random",
+        .noise    = 0.0,
+        .rounds   = EVALUATE_ROUNDS,
+    };
+    for (int i = 2; i < argc; i++)
     {
-        case move_rock:     return rocks[rock_style];
-        case move_paper:    return papers[paper_style];
-        case move_scissors: return scissors[scissor_style];
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        borrowed const char * value = argv[i + 1];
+        if (0 == strcmp(argv[i], "--opponent"))
+        {
+            config.opponent.name = value;
+        }
+        else if (0 == strcmp(argv[i], "--bot"))
+        {
+            config.opponent.bot_path = value;
+        }
+        else if (0 == strcmp(argv[i], "--table"))
+        {
+            config.opponent.table_path = value;
+        }
+        else if (0 == strcmp(argv[i], "--player"))
+        {
+            config.player = value;
+        }
+        else if (0 == strcmp(argv[i], "--player-table"))
+        {
+            config.player_table = value;
+        }
+        else if (0 == strcmp(argv[i], "--noise"))
+        {
+            config.noise = strtod(value, nil);
+        }
+        else if (0 == strcmp(argv[i], "--rounds"))
+        {
+            config.rounds = strtoull(value, nil, 10);
+        }
+        else if (0 == strcmp(argv[i], "--seed"))
+        {
+            config.opponent.seed = strtoull(value, nil, 10);
+        }
+        else if (0 == strcmp(argv[i], "--target-win-rate"))
+        {
+            config.opponent.target_win_rate = strtof(value, nil);
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        i++;
     }
-    return "?";
-}
 
-borrowed const char * get_move_name(copied move_t move)
-{
-    switch (move)
+    if (!(0.0 <= config.noise && config.noise <= 1.0)
+     || !(0.0f < config.opponent.target_win_rate && config.opponent.target_win_rate < 1.0f))
     {
-        case move_rock:     return "Rock";
-        case move_paper:    return "Paper";
-        case move_scissors: return "Scissors";
+        usage(argv[0]);
+        return EXIT_FAILURE;
     }
-    return "Unknown";
+    return evaluate(&config) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-copied result_t judge(copied move_t player, copied move_t computer)
+int main(int argc, char ** argv)
 {
-    if (player == computer)
+    if (argc >= 2 && 0 == strcmp(argv[1], "export"))
     {
-        return result_draw;
+        return export_main(argc, argv);
     }
-
-    /* Rock beats Scissors, Scissors beats Paper, Paper beats Rock */
-    if ((player == move_rock     && computer == move_scissors) ||
-        (player == move_scissors && computer == move_paper)    ||
-        (player == move_paper    && computer == move_rock))
+    if (argc >= 2 && 0 == strcmp(argv[1], "ratings"))
     {
-        return result_win;
+        return ratings_main(argc, argv);
     }
-
-    return result_lose;
-}
-
-copied move_t computer_choose()
-{
-    return (move_t)(rand() % 3);
-}
-
-copied move_t player_choose()
-{
-    borrowed const char * moves[3] = {
-        rocks[rock_style],
-        papers[paper_style],
-        scissors[scissor_style],
-    };
-
-    int8_t idx = choose_item("Your move: ", moves, 3);
-    return (move_t) idx;
-}
-
-void display_result(copied move_t player, copied move_t computer, copied result_t result)
-{
-    printf("\r\n");
-    printf("You:      %s %s\r\n", get_move_emoji(player), get_move_name(player));
-    printf("Computer: %s %s\r\n", get_move_emoji(computer), get_move_name(computer));
-    printf("\r\n");
-
-    switch (result)
-    {
-        case result_win:
-            printf("%s " CRAYON_TO_GREEN("You win!") "\r\n", trophy);
-            break;
-        case result_lose:
-            printf("%s " CRAYON_TO_RED("You lose!") "\r\n", defeated);
-            break;
-        case result_draw:
-            printf("%s " CRAYON_TO_YELLOW("It's a draw!") "\r\n", attention);
-            break;
+    if (argc >= 2 && 0 == strcmp(argv[1], "evolve"))
+    {
+        return evolve_main(argc, argv);
+    }
+    if (argc >= 2 && 0 == strcmp(argv[1], "evaluate"))
+    {
+        return evaluate_main(argc, argv);
     }
-}
-
-copied bool ask_play_again()
-{
-    printf("\r\nPlay again? [Y/n] ");
-    fflush(stdout);
 
-    loop
+    copied bool              choose_styles_again = false;
+    borrowed const char *    opponent_name       = "random";
+    borrowed const char *    bot_path            = nil;
+    borrowed const char *    table_path          = nil;
+    copied unsigned long long simulate_rounds    = 0;
+    copied bool              perf_counters       = false;
+    copied unsigned long     shards              = 0;
+    borrowed const char *    checkpoint_path     = nil;
+    copied bool              bot_protocol        = false;
+    borrowed const char *    host_path           = nil;
+    borrowed const char *    broadcast_path      = nil;
+    borrowed const char *    duel_name           = nil;
+    borrowed const char *    record_path         = nil;
+    copied bool              instant             = false;
+    copied uint64_t          seed                = rng_entropy();
+    copied f32               target_win_rate     = BANDIT_TARGET;
+    borrowed const char *    tuning_path         = nil;
+    borrowed const char *    metrics_where       = nil;
+    for (int i = 1; i < argc; i++)
     {
-        copied key_t key = keyboard_key_event();
-        if (key == 'y' || key == 'Y' || key == key_enter)
+        if (0 == strcmp(argv[i], "--choose-styles"))
         {
-            printf("Yes\r\n\r\n");
-            return true;
+            choose_styles_again = true;
         }
-        else if (key == 'n' || key == 'N' || key == (ctrl_mask | 'q'))
+        else if (0 == strcmp(argv[i], "--opponent") && i + 1 < argc)
         {
-            printf("No\r\n");
-            return false;
+            opponent_name = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--bot") && i + 1 < argc)
+        {
+            bot_path = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--table") && i + 1 < argc)
+        {
+            table_path = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--simulate") && i + 1 < argc)
+        {
+            simulate_rounds = strtoull(argv[++i], nil, 10);
+        }
+        else if (0 == strcmp(argv[i], "--shards") && i + 1 < argc)
+        {
+            shards = strtoul(argv[++i], nil, 10);
+            if (shards == 0 || shards > SHARD_MAX)
+            {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[i], "--checkpoint") && i + 1 < argc)
+        {
+            checkpoint_path = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--perf-counters"))
+        {
+            perf_counters = true;
+        }
+        else if (0 == strcmp(argv[i], "--bot-protocol"))
+        {
+            bot_protocol = true;
+        }
+        else if (0 == strcmp(argv[i], "--host") && i + 1 < argc)
+        {
+            host_path = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--duel") && i + 1 < argc)
+        {
+            duel_name = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--no-animation"))
+        {
+            instant = true;
+        }
+        else if (0 == strcmp(argv[i], "--broadcast") && i + 1 < argc)
+        {
+            broadcast_path = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--record") && i + 1 < argc)
+        {
+            record_path = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--seed") && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], nil, 10);
+        }
+        else if (0 == strcmp(argv[i], "--metrics") && i + 1 < argc)
+        {
+            metrics_where = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--tuning") && i + 1 < argc)
+        {
+            tuning_path = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--target-win-rate") && i + 1 < argc)
+        {
+            target_win_rate = strtof(argv[++i], nil);
+            if (!(0.0f < target_win_rate && target_win_rate < 1.0f))
+            {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
         }
     }
-}
 
-void choose_styles()
-{
-    printf("=== Choose Your Styles ===\r\n\r\n");
+    /* the counters are per process and the shards run in their own */
+    if (perf_counters && shards > 0)
+    {
+        fprintf(stderr, "rps: --perf-counters cannot be combined with --shards\n");
+        return EXIT_FAILURE;
+    }
 
-    rock_style    = choose_item("Rock style:     ", rocks, rocks_count);
-    paper_style   = choose_item("Paper style:    ", papers, papers_count);
-    scissor_style = choose_item("Scissors style: ", scissors, scissors_count);
+    /* before any opponent exists, so even the first round plays with the file's tuning */
+    if (tuning_path && !tuning_watch(tuning_path))
+    {
+        return EXIT_FAILURE;
+    }
 
-    printf("\r\n");
-}
+    if (metrics_where && !metrics_serve(metrics_where))
+    {
+        return EXIT_FAILURE;
+    }
 
-void play_round()
-{
-    copied move_t player_move   = player_choose();
-    copied move_t computer_move = computer_choose();
-    copied result_t result      = judge(player_move, computer_move);
+    copied strategy_spec_t opponent = {
+        .name            = opponent_name,
+        .bot_path        = bot_path,
+        .table_path      = table_path,
+        .seed            = seed,
+        .target_win_rate = target_win_rate,
+    };
 
-    display_result(player_move, computer_move, result);
-}
+    if (host_path)
+    {
+        copied host_config_t config = {
+            .path     = host_path,
+            .opponent = opponent,
+            .threads  = 0,
+            .instant  = instant,
+        };
+        return host_serve(&config) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-void setup()
-{
-    srand((unsigned int) time(nil));
-    terminal_enter_raw_mode();
-}
+    /* the workers load their own opponents, so a crashing plugin only costs its shard */
+    if (simulate_rounds > 0 && shards > 0)
+    {
+        copied shard_config_t config = {
+            .opponent   = opponent,
+            .rounds     = simulate_rounds,
+            .shards     = cast(shards, uint32_t),
+            .checkpoint = checkpoint_path,
+        };
+        return shard_simulate(&config) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-void fin()
-{
-    terminal_leave_raw_mode();
-}
+    copied rps_session_t session;
+    if (!rps_session_init(&session, STDIN_FILENO, STDOUT_FILENO, seed))
+    {
+        return EXIT_FAILURE;
+    }
+    session.instant         = instant;
+    session.target_win_rate = target_win_rate;
 
-int main()
-{
-    setup();
+    borrowed const char * error = nil;
+    if (!rps_session_load_opponent(&session, opponent_name, bot_path, table_path, &error))
+    {
+        fprintf(stderr, "rps: cannot load opponent '%s': %s\n", bot_path ? bot_path : table_path ? table_path : opponent_name, error);
+        rps_session_fin(&session);
+        return EXIT_FAILURE;
+    }
 
-    printf(CRAYON_TO_BOLD("=== Rock Paper Scissors ===") "\r\n");
-    printf("Ctrl-Q to quit anytime\r\n\r\n");
+    if (simulate_rounds > 0)
+    {
+        simulate(&session.opponent, simulate_rounds, seed, perf_counters);
+        rps_session_fin(&session);
+        return EXIT_SUCCESS;
+    }
 
-    choose_styles();
+    if (bot_protocol)
+    {
+        copied bool served = protocol_serve(&session.opponent, STDIN_FILENO, STDOUT_FILENO);
+        rps_session_fin(&session);
+        return served ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-    do
+    if (broadcast_path && !broadcast_open(&session.broadcast, broadcast_path))
     {
-        play_round();
-    } while (ask_play_again());
+        fprintf(stderr, "rps: cannot listen on '%s'\n", broadcast_path);
+        rps_session_fin(&session);
+        return EXIT_FAILURE;
+    }
+    if (broadcast_path)
+    {
+        /* spectators are served whenever the terminal waits, not just once a round */
+        terminal_wait(&session.terminal, broadcast_wait, &session.broadcast);
+    }
+
+    /* wait for the peer before raw mode, so Ctrl-C still cancels */
+    if (duel_name)
+    {
+        if (!duel_open(&session.duel, duel_name))
+        {
+            fprintf(stderr, "rps: cannot open duel '%s'\n", duel_name);
+            rps_session_fin(&session);
+            return EXIT_FAILURE;
+        }
+        if (session.duel.side == 0)
+        {
+            fprintf(stderr, "Waiting for the second player: rps --duel %s\n", duel_name);
+        }
+        duel_wait_peer(&session.duel);
+    }
+
+    if (record_path)
+    {
+        if (!recorder_open(&session.recorder, record_path, STDOUT_FILENO))
+        {
+            fprintf(stderr, "rps: cannot record to '%s'\n", record_path);
+            rps_session_fin(&session);
+            return EXIT_FAILURE;
+        }
+        terminal_tap(&session.terminal, recorder_capture, &session.recorder);
+    }
+
+    /* the computer picks its move while the player is still choosing, or inline without a thread */
+    if (!duel_name)
+    {
+        rps_session_think_ahead(&session);
+    }
+
+    /* the only process-wide setup; the assets are read-only from here on */
+    assets_measure();
 
-    printf("\r\nThanks for playing!\r\n");
+    if (!rps_session_start(&session, choose_styles_again))
+    {
+        fprintf(stderr, "rps: cannot set up the terminal\n");
+        rps_session_fin(&session);
+        return EXIT_FAILURE;
+    }
 
-    fin();
+    rps_session_run(&session);
+    rps_session_stop(&session);
+    rps_session_fin(&session);
 
     return 0;
 }
@@ -0,0 +1,183 @@
+#include "markov.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "game.h"
+
+/* The transition matrix of the joint context, CSR by destination */
+typedef struct {
+    copied uint32_t first[MARKOV_STATES + 1];   /* row j is edges first[j] .. first[j + 1] - 1 */
+    copied uint8_t  from[MARKOV_EDGES];
+    copied f64      weight[MARKOV_EDGES];
+} markov_matrix_t;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void         markov_build_(borrowed const markov_policy_t * player, borrowed const markov_policy_t * computer, borrowed markov_matrix_t * matrix);
+static copied f64   markov_step_(borrowed const markov_matrix_t * matrix, borrowed const f64 * current, borrowed f64 * next);
+static copied uint8_t markov_mirror_(copied uint32_t context);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Policies
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void markov_policy_uniform(borrowed markov_policy_t * policy)
+{
+    for (uint32_t c = 0; c < MARKOV_STATES; c++)
+    {
+        for (uint32_t m = 0; m < moves_count; m++)
+        {
+            policy->moves[c][m] = 1.0 / moves_count;
+        }
+    }
+}
+
+void markov_policy_table(borrowed markov_policy_t * policy, borrowed const uint8_t * moves)
+{
+    memset(policy, 0, sizeof(*policy));
+    for (uint32_t c = 0; c < MARKOV_STATES; c++)
+    {
+        policy->moves[c][moves[c]] = 1.0;
+    }
+}
+
+void markov_policy_mirror(borrowed markov_policy_t * policy)
+{
+    copied markov_policy_t mirrored;
+    for (uint32_t c = 0; c < MARKOV_STATES; c++)
+    {
+        memcpy(mirrored.moves[c], policy->moves[markov_mirror_(c)], sizeof(mirrored.moves[c]));
+    }
+    *policy = mirrored;
+}
+
+void markov_policy_noise(borrowed markov_policy_t * policy, copied f64 noise)
+{
+    for (uint32_t c = 0; c < MARKOV_STATES; c++)
+    {
+        for (uint32_t m = 0; m < moves_count; m++)
+        {
+            policy->moves[c][m] = (1.0 - noise) * policy->moves[c][m] + noise / moves_count;
+        }
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Solver
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool markov_evaluate(borrowed const markov_policy_t * player, borrowed const markov_policy_t * computer, borrowed markov_result_t * result)
+{
+    copied markov_matrix_t matrix;
+    markov_build_(player, computer, &matrix);
+
+    /* every match starts from context 0, as table_init() does */
+    copied f64 buffers[2][MARKOV_STATES] = { { [0] = 1.0 } };
+    copied uint32_t current  = 0;
+    copied f64      residual = INFINITY;
+    copied uint32_t steps    = 0;
+    while (steps < MARKOV_ITERATIONS && !(residual < MARKOV_TOLERANCE))
+    {
+        residual = markov_step_(&matrix, buffers[current], buffers[current ^ 1]);
+        current ^= 1;
+        steps++;
+    }
+
+    memset(result->rates, 0, sizeof(result->rates));
+    for (uint32_t c = 0; c < MARKOV_STATES; c++)
+    {
+        for (uint32_t p = 0; p < moves_count; p++)
+        {
+            for (uint32_t k = 0; k < moves_count; k++)
+            {
+                copied result_t outcome = judge(cast(p, move_t), cast(k, move_t));
+                result->rates[outcome] += buffers[current][c] * player->moves[c][p] * computer->moves[c][k];
+            }
+        }
+    }
+    result->iterations = steps;
+    result->residual   = residual;
+    return residual < MARKOV_TOLERANCE;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/* The two sides move independently given the context, so each edge is a product of their chances. */
+static void markov_build_(borrowed const markov_policy_t * player, borrowed const markov_policy_t * computer, borrowed markov_matrix_t * matrix)
+{
+    copied uint32_t counts[MARKOV_STATES] = { 0 };
+    for (uint32_t c = 0; c < MARKOV_STATES; c++)
+    {
+        for (uint32_t p = 0; p < moves_count; p++)
+        {
+            for (uint32_t k = 0; k < moves_count; k++)
+            {
+                if (player->moves[c][p] * computer->moves[c][k] > 0.0)
+                {
+                    counts[TABLE_NEXT(c, p, k)]++;
+                }
+            }
+        }
+    }
+
+    matrix->first[0] = 0;
+    for (uint32_t j = 0; j < MARKOV_STATES; j++)
+    {
+        matrix->first[j + 1] = matrix->first[j] + counts[j];
+        counts[j] = matrix->first[j];   /* now the next free edge of row j */
+    }
+
+    for (uint32_t c = 0; c < MARKOV_STATES; c++)
+    {
+        for (uint32_t p = 0; p < moves_count; p++)
+        {
+            for (uint32_t k = 0; k < moves_count; k++)
+            {
+                copied f64 weight = player->moves[c][p] * computer->moves[c][k];
+                if (weight > 0.0)
+                {
+                    copied uint32_t e = counts[TABLE_NEXT(c, p, k)]++;
+                    matrix->from[e]   = cast(c, uint8_t);
+                    matrix->weight[e] = weight;
+                }
+            }
+        }
+    }
+}
+
+/* One step of the lazy chain, next = (current + current * P) / 2. Returns the L1 change. */
+static copied f64 markov_step_(borrowed const markov_matrix_t * matrix, borrowed const f64 * current, borrowed f64 * next)
+{
+    copied f64 residual = 0.0;
+    for (uint32_t j = 0; j < MARKOV_STATES; j++)
+    {
+        copied f64 sum = 0.0;
+        for (uint32_t e = matrix->first[j]; e < matrix->first[j + 1]; e++)
+        {
+            sum += matrix->weight[e] * current[matrix->from[e]];
+        }
+        next[j]   = 0.5 * (current[j] + sum);
+        residual += fabs(next[j] - current[j]);
+    }
+    return residual;
+}
+
+/* The context with player and computer moves swapped in every round. */
+static copied uint8_t markov_mirror_(copied uint32_t context)
+{
+    copied uint32_t mirrored = 0;
+    copied uint32_t scale    = 1;
+    for (uint32_t round = 0; round < TABLE_DEPTH; round++)
+    {
+        copied uint32_t symbol = context % TABLE_SYMBOLS;
+        mirrored += ((symbol % 3) * 3 + symbol / 3) * scale;
+        context  /= TABLE_SYMBOLS;
+        scale    *= TABLE_SYMBOLS;
+    }
+    return cast(mirrored, uint8_t);
+}
@@ -0,0 +1,210 @@
+#include "meta.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define META_DECAY          (0.95f)
+#define META_SLOT_MASK      (META_CONTEXT_SLOTS - 1)
+
+/* 128-bit lanes: native on every x86-64 (SSE2) and aarch64 (NEON) target without extra flags */
+typedef int32_t v4i __attribute__((vector_size(META_LANES * sizeof(int32_t))));
+typedef f32     v4f __attribute__((vector_size(META_LANES * sizeof(f32))));
+
+static const uint8_t  _lengths[META_CONTEXT_LENGTHS]  = { 1, 2, 3, 4, 6, 8 };
+static const f32      _rates[META_FREQUENCIES]        = { 0.8f, 0.99f };
+
+/* _modulus[s][l] == base(s) ^ _lengths[l], base 3 for player/computer, 9 for joint */
+static const uint32_t _modulus[META_CONTEXT_SOURCES][META_CONTEXT_LENGTHS] = {
+    { 3, 9,  27,  81, 729,    6561     },
+    { 3, 9,  27,  81, 729,    6561     },
+    { 9, 81, 729, 6561, 531441, 43046721 },
+};
+
+/* _rotations[m][r] == (m + r) % 3, avoids 240 modulos per prediction */
+static const int32_t  _rotations[moves_count][3]      = { { 0, 1, 2 }, { 1, 2, 0 }, { 2, 0, 1 } };
+
+_Static_assert((META_CONTEXT_SLOTS & META_SLOT_MASK) == 0, "slot count must be a power of two");
+_Static_assert(META_VARIANTS % META_LANES == 0, "variants must fill whole vectors");
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void            meta_score_(borrowed meta_t * meta, copied move_t player);
+static void            meta_predict_(borrowed meta_t * meta);
+static void            meta_expand_(borrowed meta_t * meta, copied uint32_t b, copied uint8_t p, copied uint8_t q);
+static copied uint8_t  meta_argmax3_(borrowed const f32 * counts);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void meta_init(borrowed meta_t * meta, copied uint64_t seed)
+{
+    memset(meta, 0, sizeof(*meta));
+    meta->decay = META_DECAY;
+    rng_seed(&meta->rng, seed, RNG_STREAM_META);
+    meta_predict_(meta);
+}
+
+copied move_t meta_choose(borrowed meta_t * meta)
+{
+    /* per-lane running maxima, so the compare chain is a quarter as long */
+    copied v4f best;
+    copied v4i best_idx = { 0, 1, 2, 3 };
+    copied v4i idx      = { 0, 1, 2, 3 };
+    const  v4i step     = { META_LANES, META_LANES, META_LANES, META_LANES };
+    memcpy(&best, &meta->scores[0], sizeof(best));
+
+    for (uint32_t i = META_LANES; i < META_VARIANTS; i += META_LANES)
+    {
+        copied v4f scores;
+        memcpy(&scores, &meta->scores[i], sizeof(scores));
+        idx += step;
+
+        copied v4i better = scores > best;
+        best     = cast((cast(scores, v4i) & better) | (cast(best, v4i) & ~better), v4f);
+        best_idx = (idx & better) | (best_idx & ~better);
+    }
+
+    copied uint32_t winner = 0;
+    for (uint32_t lane = 1; lane < META_LANES; lane++)
+    {
+        winner = (best[lane] > best[winner]) ? lane : winner;
+    }
+
+    /* nobody is ahead: stay unexploitable */
+    if (best[winner] <= 0.0f)
+    {
+        return cast(rng_below(&meta->rng, moves_count), move_t);
+    }
+    return cast(meta->moves[best_idx[winner]], move_t);
+}
+
+void meta_observe(borrowed meta_t * meta, copied move_t player, copied move_t computer)
+{
+    meta_score_(meta, player);
+
+    /* teach every context table what followed it, the keys were hashed by the last prediction */
+    for (uint32_t t = 0; t < META_CONTEXT_TABLES; t++)
+    {
+        if (meta->rounds < _lengths[t % META_CONTEXT_LENGTHS])
+        {
+            continue;
+        }
+        copied uint32_t h = meta->keys[t];
+        meta->contexts[t][h & META_SLOT_MASK] = (meta_slot_t) {
+            .tag      = cast((h >> 16) | 1, uint16_t),
+            .player   = cast(player, uint8_t),
+            .computer = cast(computer, uint8_t),
+        };
+    }
+
+    meta->recent[0] = (meta->recent[0] * 3 + player) % _modulus[0][META_CONTEXT_LENGTHS - 1];
+    meta->recent[1] = (meta->recent[1] * 3 + computer) % _modulus[1][META_CONTEXT_LENGTHS - 1];
+    meta->recent[2] = (meta->recent[2] * 9 + player * 3 + computer) % _modulus[2][META_CONTEXT_LENGTHS - 1];
+    meta->rounds++;
+
+    for (uint8_t r = 0; r < META_FREQUENCIES; r++)
+    {
+        for (uint8_t m = 0; m < moves_count; m++)
+        {
+            meta->frequency[r][0][m] *= _rates[r];
+            meta->frequency[r][1][m] *= _rates[r];
+        }
+        meta->frequency[r][0][player]   += 1.0f;
+        meta->frequency[r][1][computer] += 1.0f;
+    }
+
+    meta_predict_(meta);
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Scoring
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void meta_score_(borrowed meta_t * meta, copied move_t player)
+{
+    copied int32_t x   = cast(player, int32_t);
+    copied v4i     px  = { x, x, x, x };
+    const  v4i     one = { 1, 1, 1, 1 };
+    const  v4i     two = { 2, 2, 2, 2 };
+
+    for (uint32_t i = 0; i < META_PADDED; i += META_LANES)
+    {
+        copied v4i moves;
+        copied v4f scores;
+        memcpy(&moves, &meta->moves[i], sizeof(moves));
+        memcpy(&scores, &meta->scores[i], sizeof(scores));
+
+        /* d == 1 or -2: the variant's move beats the player, d == 2 or -1: it loses (masks are -1) */
+        copied v4i d      = moves - px;
+        copied v4i payoff = ((d == two) | (d == -one)) - ((d == one) | (d == -two));
+
+        scores = scores * meta->decay + __builtin_convertvector(payoff, v4f);
+        memcpy(&meta->scores[i], &scores, sizeof(scores));
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Prediction
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void meta_predict_(borrowed meta_t * meta)
+{
+    copied uint8_t fallback_player   = meta_argmax3_(meta->frequency[0][0]);
+    copied uint8_t fallback_computer = meta_argmax3_(meta->frequency[0][1]);
+
+    copied uint32_t b = 0;
+    for (uint8_t s = 0; s < META_CONTEXT_SOURCES; s++)
+    {
+        for (uint8_t l = 0; l < META_CONTEXT_LENGTHS; l++, b++)
+        {
+            /* the context is the low digits of `recent`, mixed with its length and source */
+            copied uint32_t h = (meta->recent[s] % _modulus[s][l]) * 0x9E3779B1u + b * 0x85EBCA77u;
+            h ^= h >> 15;
+            h *= 0x2C1B3C6Du;
+            h ^= h >> 12;
+            meta->keys[b] = h;
+
+            copied uint8_t p = fallback_player;
+            copied uint8_t q = fallback_computer;
+            borrowed const meta_slot_t * slot = &meta->contexts[b][h & META_SLOT_MASK];
+            if (meta->rounds >= _lengths[l] && slot->tag == cast((h >> 16) | 1, uint16_t))
+            {
+                p = slot->player;
+                q = slot->computer;
+            }
+
+            meta_expand_(meta, b, p, q);
+        }
+    }
+
+    for (uint8_t f = 0; f < META_FREQUENCIES; f++, b++)
+    {
+        meta_expand_(meta, b, meta_argmax3_(meta->frequency[f][0]), meta_argmax3_(meta->frequency[f][1]));
+    }
+}
+
+/* Fills the six variants of base predictor `b` from its guesses of the player's (p) and our (q) next move. */
+static void meta_expand_(borrowed meta_t * meta, copied uint32_t b, copied uint8_t p, copied uint8_t q)
+{
+    borrowed int32_t       * moves  = &meta->moves[b * 6];
+    borrowed const int32_t * beat_p = _rotations[(p + 1) % 3];    /* beat the predicted player move */
+    borrowed const int32_t * beat_q = _rotations[(q + 2) % 3];    /* beat the player beating our predicted move */
+
+    moves[0] = beat_p[0];
+    moves[1] = beat_p[1];
+    moves[2] = beat_p[2];
+    moves[3] = beat_q[0];
+    moves[4] = beat_q[1];
+    moves[5] = beat_q[2];
+}
+
+static copied uint8_t meta_argmax3_(borrowed const f32 * counts)
+{
+    copied uint8_t best = 0;
+    if (counts[1] > counts[best]) best = 1;
+    if (counts[2] > counts[best]) best = 2;
+    return best;
+}
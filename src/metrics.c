@@ -0,0 +1,315 @@
+#include "metrics.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "monotonic.h"
+
+#define METRICS_SEND_TIMEOUT_S  (1)
+#define METRICS_HTTP_HEADER     "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\n\r\n"
+
+typedef struct {
+    borrowed const char * name;
+    borrowed const char * labels;       /* nil for none */
+    borrowed const char * type;
+    borrowed const char * help;         /* once per name, on its first entry */
+} metrics_info_t;
+
+static const metrics_info_t _info[metrics_count] = {
+    [metric_rounds_draw]      = { "rps_rounds_total", "result=\"draw\"", "counter", "Rounds played, by result from the player's side." },
+    [metric_rounds_win]       = { "rps_rounds_total", "result=\"win\"", "counter", nil },
+    [metric_rounds_lose]      = { "rps_rounds_total", "result=\"lose\"", "counter", nil },
+    [metric_keys_text]        = { "rps_keys_total", "kind=\"text\"", "counter", "Keys read from terminals, by kind." },
+    [metric_keys_editing]     = { "rps_keys_total", "kind=\"editing\"", "counter", nil },
+    [metric_keys_control]     = { "rps_keys_total", "kind=\"control\"", "counter", nil },
+    [metric_keys_alt]         = { "rps_keys_total", "kind=\"alt\"", "counter", nil },
+    [metric_keys_navigation]  = { "rps_keys_total", "kind=\"navigation\"", "counter", nil },
+    [metric_keys_function]    = { "rps_keys_total", "kind=\"function\"", "counter", nil },
+    [metric_keys_unknown]     = { "rps_keys_total", "kind=\"unknown\"", "counter", nil },
+    [metric_terminal_bytes]   = { "rps_terminal_written_bytes_total", nil, "counter", "Bytes written to terminals." },
+    [metric_terminal_writes]  = { "rps_terminal_writes_total", nil, "counter", "write() calls made for terminals." },
+    [metric_sessions_started] = { "rps_sessions_started_total", nil, "counter", "Sessions that took over a terminal." },
+    [metric_sessions_active]  = { "rps_sessions_active", nil, "gauge", "Sessions playing right now." },
+};
+
+_Thread_local metrics_block_t           * metrics_local = nil;
+static _Atomic(metrics_block_t *)         _blocks       = nil;
+static pthread_key_t                      _block_key;
+static pthread_once_t                     _block_once   = PTHREAD_ONCE_INIT;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void          metrics_block_key_(void);
+static void          metrics_block_release_(borrowed void * block);
+static copied int    metrics_listen_(borrowed const char * where);
+static void *        metrics_serve_main_(copied void * context);
+static void          metrics_answer_(copied int fd);
+static copied size_t metrics_format_(borrowed char * text, copied size_t size);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Counting
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+borrowed metrics_block_t * metrics_claim(void)
+{
+    pthread_once(&_block_once, metrics_block_key_);
+
+    /* a block left by an exited thread keeps its values: they are part of the totals */
+    borrowed metrics_block_t * block = atomic_load(&_blocks);
+    for (; block; block = block->next)
+    {
+        copied bool free_block = false;
+        if (atomic_compare_exchange_strong(&block->used, &free_block, true))
+        {
+            break;
+        }
+    }
+
+    if (!block)
+    {
+        block = aligned_alloc(_Alignof(metrics_block_t), sizeof(metrics_block_t));
+        if (!block)
+        {
+            return nil;
+        }
+        for (uint32_t i = 0; i < metrics_count; i++)
+        {
+            atomic_init(&block->values[i], 0);
+        }
+        atomic_init(&block->used, true);
+        block->next = atomic_load(&_blocks);
+        while (!atomic_compare_exchange_weak(&_blocks, &block->next, block))
+        {
+        }
+    }
+
+    pthread_setspecific(_block_key, block);
+    metrics_local = block;
+    return block;
+}
+
+void metrics_collect(borrowed int64_t * values)
+{
+    memset(values, 0, sizeof(int64_t) * metrics_count);
+    for (metrics_block_t * block = atomic_load(&_blocks); block; block = block->next)
+    {
+        for (uint32_t i = 0; i < metrics_count; i++)
+        {
+            values[i] += atomic_load_explicit(&block->values[i], memory_order_relaxed);
+        }
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Serving
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool metrics_serve(borrowed const char * where)
+{
+    copied int fd = metrics_listen_(where);
+    if (fd < 0)
+    {
+        fprintf(stderr, "rps: cannot serve metrics on '%s': %s\n", where, strerror(errno));
+        return false;
+    }
+
+    copied pthread_t thread;
+    copied int       err = pthread_create(&thread, nil, metrics_serve_main_, cast(cast(fd, intptr_t), void *));
+    if (err != 0)
+    {
+        fprintf(stderr, "rps: cannot serve metrics on '%s': %s\n", where, strerror(err));
+        close(fd);
+        return false;
+    }
+    pthread_detach(thread);
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void metrics_block_key_(void)
+{
+    pthread_key_create(&_block_key, metrics_block_release_);
+}
+
+static void metrics_block_release_(borrowed void * block)
+{
+    borrowed metrics_block_t * released = block;
+    atomic_store(&released->used, false);
+}
+
+/* A port number listens on loopback, anything else is a Unix socket path. */
+static copied int metrics_listen_(borrowed const char * where)
+{
+    borrowed char * end  = nil;
+    copied   long   port = strtol(where, &end, 10);
+    copied   bool   tcp  = *where && *end == '\0';
+    if (tcp && (port <= 0 || port > 65535))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    copied int fd = socket(tcp ? AF_INET : AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    copied int bound;
+    if (tcp)
+    {
+        copied int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        copied struct sockaddr_in addr = {
+            .sin_family      = AF_INET,
+            .sin_port        = htons(cast(port, uint16_t)),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+        };
+        bound = bind(fd, cast(&addr, struct sockaddr *), sizeof(addr));
+    }
+    else
+    {
+        copied struct sockaddr_un addr = { .sun_family = AF_UNIX };
+        if (strlen(where) >= sizeof(addr.sun_path))
+        {
+            close(fd);
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        strcpy(addr.sun_path, where);
+        unlink(where);
+        bound = bind(fd, cast(&addr, struct sockaddr *), sizeof(addr));
+    }
+
+    if (bound < 0 || listen(fd, METRICS_BACKLOG) < 0)
+    {
+        copied int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
+
+/* Scrapes are rare and short, so clients are answered one at a time. */
+static void * metrics_serve_main_(copied void * context)
+{
+    copied int listen_fd = cast(cast(context, intptr_t), int);
+    for (;;)
+    {
+        copied int fd = accept(listen_fd, nil, nil);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED || errno == EMFILE || errno == ENFILE)
+            {
+                continue;
+            }
+            break;
+        }
+        metrics_answer_(fd);
+        close(fd);
+    }
+    close(listen_fd);
+    return nil;
+}
+
+/* Reads the request, if any, until its blank line or a pause, then answers and hangs up. */
+static void metrics_answer_(copied int fd)
+{
+    copied struct timeval send_timeout = { .tv_sec = METRICS_SEND_TIMEOUT_S };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+
+    copied char    request[METRICS_REQUEST + 1];
+    copied size_t  got      = 0;
+    copied int64_t deadline = cast(monotonic_ns() / NSEC_PER_MSEC, int64_t) + 4 * METRICS_IDLE_MS;
+    while (got < METRICS_REQUEST)
+    {
+        copied int64_t left = deadline - cast(monotonic_ns() / NSEC_PER_MSEC, int64_t);
+        copied struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if (left <= 0 || poll(&pfd, 1, left < METRICS_IDLE_MS ? cast(left, int) : METRICS_IDLE_MS) <= 0)
+        {
+            break;
+        }
+        copied ssize_t n = read(fd, request + got, METRICS_REQUEST - got);
+        if (n <= 0)
+        {
+            break;
+        }
+        got += cast(n, size_t);
+        request[got] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n"))
+        {
+            break;
+        }
+    }
+    request[got] = '\0';
+
+    copied char   text[METRICS_TEXT];
+    copied size_t len  = 0;
+    copied bool   http = 0 == strncmp(request, "GET ", 4) || 0 == strncmp(request, "HEAD ", 5);
+    if (http)
+    {
+        memcpy(text, METRICS_HTTP_HEADER, sizeof(METRICS_HTTP_HEADER) - 1);
+        len = sizeof(METRICS_HTTP_HEADER) - 1;
+    }
+    if (0 != strncmp(request, "HEAD ", 5))
+    {
+        len += metrics_format_(text + len, sizeof(text) - len);
+    }
+
+    for (size_t sent = 0; sent < len; )
+    {
+        copied ssize_t n = send(fd, text + sent, len - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return;
+        }
+        sent += cast(n, size_t);
+    }
+}
+
+static copied size_t metrics_format_(borrowed char * text, copied size_t size)
+{
+    copied int64_t values[metrics_count];
+    metrics_collect(values);
+
+    copied size_t len = 0;
+    for (uint32_t i = 0; i < metrics_count && len < size; i++)
+    {
+        borrowed const metrics_info_t * info = &_info[i];
+        copied int n = 0;
+        if (info->help)
+        {
+            n = snprintf(text + len, size - len, "# HELP %s %s\n# TYPE %s %s\n", info->name, info->help, info->name, info->type);
+            len += (n > 0) ? cast(n, size_t) : 0;
+            if (len >= size)
+            {
+                break;
+            }
+        }
+        n = info->labels
+          ? snprintf(text + len, size - len, "%s{%s} %lld\n", info->name, info->labels, cast(values[i], long long))
+          : snprintf(text + len, size - len, "%s %lld\n", info->name, cast(values[i], long long));
+        len += (n > 0) ? cast(n, size_t) : 0;
+    }
+    return (len < size) ? len : size - 1;
+}
@@ -0,0 +1,160 @@
+/* syscall() is not part of POSIX */
+#define _DEFAULT_SOURCE
+
+#include "perf.h"
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/* What read() returns for one counter opened with the time fields */
+typedef struct {
+    copied uint64_t value;
+    copied uint64_t time_enabled;
+    copied uint64_t time_running;
+} perf_reading_t;
+
+static const uint64_t perf_events_[perf_counter_count] = {
+    [perf_cycles]        = PERF_COUNT_HW_CPU_CYCLES,
+    [perf_instructions]  = PERF_COUNT_HW_INSTRUCTIONS,
+    [perf_branch_misses] = PERF_COUNT_HW_BRANCH_MISSES,
+    [perf_cache_misses]  = PERF_COUNT_HW_CACHE_MISSES,
+};
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Lifecycle
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool perf_counters_open(borrowed perf_counters_t * perf)
+{
+    memset(perf, 0, sizeof(*perf));
+
+    copied bool any = false;
+    for (int i = 0; i < perf_counter_count; i++)
+    {
+        copied struct perf_event_attr attr = {
+            .type           = PERF_TYPE_HARDWARE,
+            .size           = sizeof(attr),
+            .config         = perf_events_[i],
+            .read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING,
+            .disabled       = 1,
+            .inherit        = 1,
+            .exclude_kernel = 1,
+            .exclude_hv     = 1,
+        };
+        perf->fd[i] = cast(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC), int);
+        if (perf->fd[i] < 0)
+        {
+            perf->error[i] = errno;
+        }
+        any = any || perf->fd[i] >= 0;
+    }
+    return any;
+}
+
+void perf_counters_close(borrowed perf_counters_t * perf)
+{
+    for (int i = 0; i < perf_counter_count; i++)
+    {
+        if (perf->fd[i] >= 0)
+        {
+            close(perf->fd[i]);
+        }
+        perf->fd[i] = -1;
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Measuring
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void perf_counters_start(borrowed perf_counters_t * perf)
+{
+    for (int i = 0; i < perf_counter_count; i++)
+    {
+        if (perf->fd[i] >= 0)
+        {
+            ioctl(perf->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(perf->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void perf_counters_stop(borrowed perf_counters_t * perf)
+{
+    perf_counters_pause(perf);
+
+    for (int i = 0; i < perf_counter_count; i++)
+    {
+        perf->values[i] = 0;
+
+        copied perf_reading_t reading;
+        if (perf->fd[i] < 0 || sizeof(reading) != read(perf->fd[i], &reading, sizeof(reading)))
+        {
+            continue;
+        }
+
+        /* multiplexed: extrapolate from the share of the run the counter was live */
+        perf->values[i] = reading.value;
+        if (reading.time_running > 0 && reading.time_running < reading.time_enabled)
+        {
+            perf->values[i] = cast(cast(reading.value, f64) * reading.time_enabled / reading.time_running, uint64_t);
+        }
+    }
+}
+
+void perf_counters_pause(borrowed perf_counters_t * perf)
+{
+    for (int i = 0; i < perf_counter_count; i++)
+    {
+        if (perf->fd[i] >= 0)
+        {
+            ioctl(perf->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+}
+
+void perf_counters_resume(borrowed perf_counters_t * perf)
+{
+    for (int i = 0; i < perf_counter_count; i++)
+    {
+        if (perf->fd[i] >= 0)
+        {
+            ioctl(perf->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Report
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void perf_counters_report(borrowed const perf_counters_t * perf, copied uint64_t rounds, borrowed FILE * out)
+{
+    static const char * const labels[perf_counter_count] = {
+        [perf_cycles]        = "cycles:",
+        [perf_instructions]  = "instructions:",
+        [perf_branch_misses] = "branch misses:",
+        [perf_cache_misses]  = "cache misses:",
+    };
+
+    copied f64 per = rounds ? 1.0 / cast(rounds, f64) : 0.0;
+    for (int i = 0; i < perf_counter_count; i++)
+    {
+        if (perf->fd[i] < 0)
+        {
+            fprintf(out, "%-14s unavailable (%s)\n", labels[i], strerror(perf->error[i]));
+            continue;
+        }
+
+        fprintf(out, "%-14s %llu (%.3f/round", labels[i], cast(perf->values[i], unsigned long long), cast(perf->values[i], f64) * per);
+        if (i == perf_instructions && perf->fd[perf_cycles] >= 0 && perf->values[perf_cycles] > 0)
+        {
+            fprintf(out, ", IPC %.2f", cast(perf->values[perf_instructions], f64) / cast(perf->values[perf_cycles], f64));
+        }
+        fprintf(out, ")\n");
+    }
+}
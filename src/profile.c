@@ -0,0 +1,181 @@
+#include "profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "rating.h"
+
+#define PROFILE_PATH_MAX    (4096)
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool profile_path_(borrowed char * buf, copied size_t size);
+static copied bool profile_write_all_(copied int fd, borrowed const void * data, copied size_t len);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void profile_init(borrowed profile_t * profile)
+{
+    memset(profile, 0, sizeof(*profile));
+    profile->magic     = PROFILE_MAGIC;
+    profile->version   = PROFILE_VERSION;
+    profile->size      = sizeof(profile_t);
+    profile->rating    = RATING_INITIAL;
+    profile->deviation = RATING_DEVIATION;
+}
+
+copied bool profile_load(borrowed profile_t * profile)
+{
+    profile_init(profile);
+
+    copied char path[PROFILE_PATH_MAX];
+    if (!profile_path_(path, sizeof(path)))
+    {
+        return false;
+    }
+
+    copied int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    copied struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < cast(PROFILE_V1_SIZE, off_t))
+    {
+        close(fd);
+        return false;
+    }
+
+    borrowed void * map = mmap(nil, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+
+    /* an older profile is a prefix of this one, the fields it lacks keep their fresh values */
+    borrowed const profile_t * stored = cast(map, const profile_t *);
+    static const size_t sizes[PROFILE_VERSION + 1] = { 0, PROFILE_V1_SIZE, PROFILE_V2_SIZE, sizeof(profile_t) };
+    copied size_t expected = (1 <= stored->version && stored->version <= PROFILE_VERSION) ? sizes[stored->version] : 0;
+    copied bool   valid    = stored->magic == PROFILE_MAGIC
+                          && expected > 0
+                          && stored->size == expected
+                          && cast(expected, off_t) <= st.st_size;
+    if (valid)
+    {
+        memcpy(profile, stored, expected);
+        memset(profile->unused, 0, sizeof(profile->unused));
+        profile->version = PROFILE_VERSION;
+        profile->size    = sizeof(profile_t);
+    }
+
+    munmap(map, st.st_size);
+    return valid;
+}
+
+copied bool profile_save(borrowed const profile_t * profile)
+{
+    copied char path[PROFILE_PATH_MAX];
+    copied char temp[PROFILE_PATH_MAX + 32];
+    if (!profile_path_(path, sizeof(path)))
+    {
+        return false;
+    }
+    snprintf(temp, sizeof(temp), "%s.tmp.%ld", path, cast(getpid(), long));
+
+    copied int fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    if (!profile_write_all_(fd, profile, sizeof(*profile)) || fsync(fd) < 0)
+    {
+        close(fd);
+        unlink(temp);
+        return false;
+    }
+    close(fd);
+
+    if (rename(temp, path) < 0)
+    {
+        unlink(temp);
+        return false;
+    }
+    return true;
+}
+
+borrowed profile_opponent_t * profile_opponent(borrowed profile_t * profile, copied uint64_t id)
+{
+    borrowed profile_opponent_t * entry = &profile->opponents[0];
+    for (uint32_t i = 0; i < PROFILE_OPPONENTS; i++)
+    {
+        borrowed profile_opponent_t * opponent = &profile->opponents[i];
+        if (opponent->id == id)
+        {
+            return opponent;
+        }
+        if (opponent->id == 0 ? entry->id != 0 : (entry->id != 0 && opponent->games < entry->games))
+        {
+            entry = opponent;
+        }
+    }
+
+    *entry = (profile_opponent_t) {
+        .id        = id,
+        .rating    = RATING_INITIAL,
+        .deviation = RATING_DEVIATION,
+    };
+    return entry;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool profile_path_(borrowed char * buf, copied size_t size)
+{
+    borrowed const char * env = getenv(PROFILE_ENV);
+    if (env && env[0])
+    {
+        return cast(snprintf(buf, size, "%s", env), size_t) < size;
+    }
+
+    borrowed const char * home = getenv("HOME");
+    if (!home || !home[0])
+    {
+        return false;
+    }
+    return cast(snprintf(buf, size, "%s/%s", home, PROFILE_FILENAME), size_t) < size;
+}
+
+static copied bool profile_write_all_(copied int fd, borrowed const void * data, copied size_t len)
+{
+    borrowed const char * p = data;
+    while (len > 0)
+    {
+        copied ssize_t n = write(fd, p, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        p   += n;
+        len -= n;
+    }
+    return true;
+}
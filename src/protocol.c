@@ -0,0 +1,163 @@
+#include "protocol.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "metrics.h"
+#include "sketch.h"
+
+#define PROTOCOL_SKIP   (0xfe)      /* decoded byte: whitespace, answered with nothing */
+#define PROTOCOL_ECHO   (0xff)      /* decoded byte: newline or junk, answered as is */
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied uint8_t  protocol_decode_(copied uint8_t c);
+static copied ssize_t  protocol_read_(copied int fd, borrowed uint8_t * buffer, copied size_t size);
+static copied bool     protocol_write_(copied int fd, borrowed const uint8_t * buffer, copied size_t len);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Serve Loop
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool protocol_serve(borrowed strategy_t * opponent, copied int in, copied int out)
+{
+    copied history_t        history;
+    copied sketch_context_t sketch;
+    sketch_context_init(&sketch);
+    if (!history_init(&history, HISTORY_WINDOW))
+    {
+        fprintf(stderr, "rps: out of memory\n");
+        return false;
+    }
+
+    owned uint8_t * input    = malloc(PROTOCOL_BUFFER);
+    owned uint8_t * output   = malloc(2 * PROTOCOL_BUFFER);
+    owned uint8_t * player   = malloc(PROTOCOL_BUFFER);
+    owned uint8_t * computer = malloc(PROTOCOL_BUFFER);
+    owned uint8_t * results  = malloc(PROTOCOL_BUFFER);
+    copied bool     ok       = input && output && player && computer && results;
+    if (!ok)
+    {
+        fprintf(stderr, "rps: out of memory\n");
+    }
+
+    while (ok)
+    {
+        copied ssize_t got = protocol_read_(in, input, PROTOCOL_BUFFER);
+        if (got <= 0)
+        {
+            ok = (got == 0);
+            break;
+        }
+
+        /* the moves of this read, in order */
+        copied uint32_t rounds = 0;
+        for (ssize_t i = 0; i < got; i++)
+        {
+            copied uint8_t move = protocol_decode_(input[i]);
+            if (move < moves_count)
+            {
+                player[rounds++] = move;
+            }
+        }
+
+        /* play them, committing up to `batch` moves against the same history */
+        for (uint32_t done = 0; done < rounds; )
+        {
+            copied uint32_t n = (rounds - done < opponent->batch) ? rounds - done : opponent->batch;
+            strategy_choose_n(opponent, &history, n, computer + done);
+            for (uint32_t i = done; i < done + n; i++)
+            {
+                history_push(&history, cast(player[i], move_t), cast(computer[i], move_t));
+                if (opponent->reads_sketch)
+                {
+                    sketch_observe(&sketch, cast(player[i], move_t));
+                }
+                strategy_observe(opponent, cast(player[i], move_t), cast(computer[i], move_t));
+            }
+            done += n;
+        }
+        judge_n(player, computer, rounds, results);
+
+        /* answer byte for byte, in the order the client wrote them */
+        copied size_t   used  = 0;
+        copied uint32_t round = 0;
+        for (ssize_t i = 0; i < got; i++)
+        {
+            copied uint8_t move = protocol_decode_(input[i]);
+            if (move < moves_count)
+            {
+                output[used++] = cast("rps"[computer[round]], uint8_t);
+                output[used++] = cast("dwl"[results[round]], uint8_t);
+                metrics_add(metric_rounds_draw + results[round], 1);
+                round++;
+            }
+            else if (move == PROTOCOL_ECHO)
+            {
+                output[used++] = (input[i] == '\n') ? '\n' : '?';
+            }
+        }
+
+        ok = protocol_write_(out, output, used);
+    }
+
+    free(results);
+    free(computer);
+    free(player);
+    free(output);
+    free(input);
+    history_free(&history);
+    return ok;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/* A move_t, PROTOCOL_SKIP or PROTOCOL_ECHO. */
+static copied uint8_t protocol_decode_(copied uint8_t c)
+{
+    switch (c)
+    {
+        case 'r': case 'R': case '0': return move_rock;
+        case 'p': case 'P': case '1': return move_paper;
+        case 's': case 'S': case '2': return move_scissors;
+        case ' ': case '\t': case '\r': return PROTOCOL_SKIP;
+        default:                        return PROTOCOL_ECHO;
+    }
+}
+
+static copied ssize_t protocol_read_(copied int fd, borrowed uint8_t * buffer, copied size_t size)
+{
+    for (;;)
+    {
+        copied ssize_t n = read(fd, buffer, size);
+        if (n >= 0 || errno != EINTR)
+        {
+            return n;
+        }
+    }
+}
+
+static copied bool protocol_write_(copied int fd, borrowed const uint8_t * buffer, copied size_t len)
+{
+    while (len > 0)
+    {
+        copied ssize_t n = write(fd, buffer, len);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            return false;
+        }
+        buffer += n;
+        len    -= cast(n, size_t);
+    }
+    return true;
+}
@@ -0,0 +1,453 @@
+#include "rating.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RATING_MIN_DEVIATION    (30.0f)
+#define RATING_DRIFT            (15.0f)     /* deviation regained before every game */
+#define RATING_Q                (0.0057565f) /* ln(10) / 400 */
+#define RATING_PI2              (9.8696044f)
+
+/* Slots resolved per chunk of a batch, kept small enough to stay on the stack */
+#define RATING_CHUNK            (1024)
+
+/* How many games ahead a batch prefetches */
+#define RATING_PREFETCH         (8)
+
+/* A top-K candidate, the rating is copied next to the slot so sorting stays local */
+typedef struct {
+    copied f32      rating;
+    copied uint32_t slot;
+} rating_rank_t;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied uint64_t rating_hash_(copied uint64_t id);
+static copied bool     rating_grow_(borrowed rating_table_t * table);
+static copied bool     rating_reindex_(borrowed rating_table_t * table, copied uint32_t cells);
+static copied uint32_t rating_bucket_(copied f32 rating);
+static void            rating_fenwick_build_(borrowed rating_table_t * table);
+static copied uint32_t rating_fenwick_prefix_(borrowed const rating_table_t * table, copied uint32_t bucket);
+static copied uint32_t rating_fenwick_search_(borrowed const rating_table_t * table, copied uint32_t rank);
+static void            rating_apply_(borrowed rating_table_t * table, copied uint32_t a, copied uint32_t b, copied f32 score);
+static copied int      rating_compare_desc_(borrowed const void * lhs, borrowed const void * rhs);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool rating_init(borrowed rating_table_t * table, copied uint32_t capacity)
+{
+    memset(table, 0, sizeof(*table));
+
+    table->counts  = calloc(RATING_BUCKETS, sizeof(uint32_t));
+    table->buckets = calloc(RATING_BUCKETS + 1, sizeof(uint32_t));
+    if (!table->counts || !table->buckets)
+    {
+        rating_free(table);
+        return false;
+    }
+
+    table->capacity = (capacity < 16) ? 16 : capacity;
+    table->ids        = malloc(table->capacity * sizeof(uint64_t));
+    table->ratings    = malloc(table->capacity * sizeof(f32));
+    table->deviations = malloc(table->capacity * sizeof(f32));
+    table->games      = malloc(table->capacity * sizeof(uint32_t));
+
+    copied uint32_t cells = 32;
+    while (cells < 2 * table->capacity)
+    {
+        cells <<= 1;
+    }
+
+    if (!table->ids || !table->ratings || !table->deviations || !table->games || !rating_reindex_(table, cells))
+    {
+        rating_free(table);
+        return false;
+    }
+    return true;
+}
+
+void rating_free(borrowed rating_table_t * table)
+{
+    free(table->ids);
+    free(table->ratings);
+    free(table->deviations);
+    free(table->games);
+    free(table->index);
+    free(table->counts);
+    free(table->buckets);
+    memset(table, 0, sizeof(*table));
+}
+
+copied uint64_t rating_id(borrowed const char * name)
+{
+    /* FNV-1a */
+    copied uint64_t hash = 0xcbf29ce484222325ull;
+    for (; *name; name++)
+    {
+        hash ^= cast(*name, uint8_t);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+copied int64_t rating_find(borrowed const rating_table_t * table, copied uint64_t id)
+{
+    for (uint32_t cell = rating_hash_(id) & table->index_mask; ; cell = (cell + 1) & table->index_mask)
+    {
+        borrowed const rating_cell_t * entry = &table->index[cell];
+        if (entry->slot == 0)
+        {
+            return -1;
+        }
+        if (entry->id == id)
+        {
+            return entry->slot - 1;
+        }
+    }
+}
+
+copied int64_t rating_add(borrowed rating_table_t * table, copied uint64_t id, copied f32 rating, copied f32 deviation, copied uint32_t games)
+{
+    copied uint32_t cell = rating_hash_(id) & table->index_mask;
+    for (; table->index[cell].slot != 0; cell = (cell + 1) & table->index_mask)
+    {
+        if (table->index[cell].id == id)
+        {
+            return table->index[cell].slot - 1;
+        }
+    }
+
+    if (table->count == table->capacity)
+    {
+        if (!rating_grow_(table))
+        {
+            return -1;
+        }
+        /* the index was rebuilt, find the empty cell again */
+        for (cell = rating_hash_(id) & table->index_mask; table->index[cell].slot != 0; cell = (cell + 1) & table->index_mask)
+        {
+        }
+    }
+
+    copied uint32_t slot = table->count++;
+    table->ids[slot]        = id;
+    table->ratings[slot]    = rating;
+    table->deviations[slot] = deviation;
+    table->games[slot]      = games;
+    table->index[cell]      = (rating_cell_t) { .id = id, .slot = slot + 1 };
+    table->counts[rating_bucket_(rating)]++;
+    table->stale = true;
+    return slot;
+}
+
+copied bool rating_update(borrowed rating_table_t * table, borrowed const rating_game_t * game)
+{
+    return rating_update_batch(table, game, 1);
+}
+
+copied bool rating_update_batch(borrowed rating_table_t * table, borrowed const rating_game_t * games, copied size_t count)
+{
+    copied uint32_t slots[RATING_CHUNK][2];
+
+    for (size_t base = 0; base < count; base += RATING_CHUNK)
+    {
+        copied size_t n = (count - base < RATING_CHUNK) ? count - base : RATING_CHUNK;
+
+        /* pass 1: id -> slot for the whole chunk, adding newcomers; index cells are
+         * prefetched a few games ahead so several lookups miss the cache at once */
+        for (size_t i = 0; i < n; i++)
+        {
+            if (i + RATING_PREFETCH < n)
+            {
+                __builtin_prefetch(&table->index[rating_hash_(games[base + i + RATING_PREFETCH].player)   & table->index_mask]);
+                __builtin_prefetch(&table->index[rating_hash_(games[base + i + RATING_PREFETCH].opponent) & table->index_mask]);
+            }
+
+            copied int64_t a = rating_add(table, games[base + i].player,   RATING_INITIAL, RATING_DEVIATION, 0);
+            copied int64_t b = rating_add(table, games[base + i].opponent, RATING_INITIAL, RATING_DEVIATION, 0);
+            if (a < 0 || b < 0)
+            {
+                return false;
+            }
+            slots[i][0] = cast(a, uint32_t);
+            slots[i][1] = cast(b, uint32_t);
+        }
+
+        /* pass 2: games in order, later games see the effect of earlier ones */
+        for (size_t i = 0; i < n; i++)
+        {
+            if (i + RATING_PREFETCH < n)
+            {
+                for (int side = 0; side < 2; side++)
+                {
+                    copied uint32_t ahead = slots[i + RATING_PREFETCH][side];
+                    __builtin_prefetch(&table->ratings[ahead], 1);
+                    __builtin_prefetch(&table->deviations[ahead], 1);
+                    __builtin_prefetch(&table->games[ahead], 1);
+                }
+            }
+
+            if (slots[i][0] != slots[i][1])
+            {
+                rating_apply_(table, slots[i][0], slots[i][1], games[base + i].score);
+            }
+        }
+    }
+    table->stale = true;
+    return true;
+}
+
+copied f32 rating_percentile(borrowed rating_table_t * table, copied uint32_t slot)
+{
+    rating_fenwick_build_(table);
+
+    copied uint32_t bucket = rating_bucket_(table->ratings[slot]);
+    copied uint32_t below  = (bucket == 0) ? 0 : rating_fenwick_prefix_(table, bucket - 1);
+    return cast(below, f32) / cast(table->count, f32);
+}
+
+copied uint32_t rating_top(borrowed rating_table_t * table, copied uint32_t k, borrowed uint32_t * slots)
+{
+    rating_fenwick_build_(table);
+
+    if (k > table->count)
+    {
+        k = table->count;
+    }
+    if (k == 0)
+    {
+        return 0;
+    }
+
+    /* the bucket holding the k-th best: everything rated there or above is a candidate */
+    copied uint32_t cutoff     = rating_fenwick_search_(table, table->count - k + 1);
+    copied uint32_t candidates = table->count - ((cutoff == 0) ? 0 : rating_fenwick_prefix_(table, cutoff - 1));
+
+    owned rating_rank_t * found = malloc(candidates * sizeof(rating_rank_t));
+    if (!found)
+    {
+        return 0;
+    }
+
+    copied uint32_t n = 0;
+    for (uint32_t slot = 0; slot < table->count && n < candidates; slot++)
+    {
+        if (rating_bucket_(table->ratings[slot]) >= cutoff)
+        {
+            found[n++] = (rating_rank_t) { .rating = table->ratings[slot], .slot = slot };
+        }
+    }
+
+    qsort(found, n, sizeof(rating_rank_t), rating_compare_desc_);
+    if (k > n)
+    {
+        k = n;
+    }
+    for (uint32_t i = 0; i < k; i++)
+    {
+        slots[i] = found[i].slot;
+    }
+    free(found);
+    return k;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Glicko
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/* Glicko's g() attenuation, from the squared deviation. */
+static copied f32 rating_g_(copied f32 variance)
+{
+    return 1.0f / sqrtf(1.0f + 3.0f * RATING_Q * RATING_Q * variance / RATING_PI2);
+}
+
+/*
+ * One game as its own rating period, both players updated from their pre-game values.
+ * Deviations are carried squared until the end, which saves the square roots of the drift.
+ */
+static void rating_apply_(borrowed rating_table_t * table, copied uint32_t a, copied uint32_t b, copied f32 score)
+{
+    copied uint32_t slot[2] = { a, b };
+    copied f32      r[2]    = { table->ratings[a], table->ratings[b] };
+    copied f32      s[2]    = { score, 1.0f - score };
+    copied f32      var[2];
+
+    for (int i = 0; i < 2; i++)
+    {
+        copied f32 rd = table->deviations[slot[i]];
+        var[i] = fminf(rd * rd + RATING_DRIFT * RATING_DRIFT, RATING_DEVIATION * RATING_DEVIATION);
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        copied int j         = 1 - i;
+        copied f32 g         = rating_g_(var[j]);
+        copied f32 expected  = 1.0f / (1.0f + expf(-g * (r[i] - r[j]) * RATING_Q));
+        copied f32 d2_inv    = RATING_Q * RATING_Q * g * g * expected * (1.0f - expected);
+        copied f32 precision = 1.0f / var[i] + d2_inv;
+        copied f32 rating    = r[i] + RATING_Q / precision * g * (s[i] - expected);
+
+        /* branchless on purpose: most games leave the bucket unchanged, unpredictably */
+        table->counts[rating_bucket_(r[i])]--;
+        table->counts[rating_bucket_(rating)]++;
+
+        table->ratings[slot[i]]    = rating;
+        table->deviations[slot[i]] = fmaxf(sqrtf(1.0f / precision), RATING_MIN_DEVIATION);
+        table->games[slot[i]]++;
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Index
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied uint64_t rating_hash_(copied uint64_t id)
+{
+    /* splitmix64 finalizer, ids may be sequential */
+    id ^= id >> 30;
+    id *= 0xbf58476d1ce4e5b9ull;
+    id ^= id >> 27;
+    id *= 0x94d049bb133111ebull;
+    id ^= id >> 31;
+    return id;
+}
+
+static copied bool rating_grow_(borrowed rating_table_t * table)
+{
+    copied uint32_t capacity = table->capacity * 2;
+
+    /* each array is swapped in as soon as it is resized, so a failure leaves a consistent table */
+    borrowed uint64_t * ids = realloc(table->ids, capacity * sizeof(uint64_t));
+    if (!ids)
+    {
+        return false;
+    }
+    table->ids = ids;
+
+    borrowed f32 * ratings = realloc(table->ratings, capacity * sizeof(f32));
+    if (!ratings)
+    {
+        return false;
+    }
+    table->ratings = ratings;
+
+    borrowed f32 * deviations = realloc(table->deviations, capacity * sizeof(f32));
+    if (!deviations)
+    {
+        return false;
+    }
+    table->deviations = deviations;
+
+    borrowed uint32_t * games = realloc(table->games, capacity * sizeof(uint32_t));
+    if (!games)
+    {
+        return false;
+    }
+    table->games = games;
+
+    table->capacity = capacity;
+
+    /* keep the index at most half full */
+    return (2 * capacity <= table->index_mask + 1) || rating_reindex_(table, 2 * (table->index_mask + 1));
+}
+
+static copied bool rating_reindex_(borrowed rating_table_t * table, copied uint32_t cells)
+{
+    owned rating_cell_t * index = calloc(cells, sizeof(rating_cell_t));
+    if (!index)
+    {
+        return false;
+    }
+
+    copied uint32_t mask = cells - 1;
+    for (uint32_t slot = 0; slot < table->count; slot++)
+    {
+        copied uint32_t cell = rating_hash_(table->ids[slot]) & mask;
+        while (index[cell].slot != 0)
+        {
+            cell = (cell + 1) & mask;
+        }
+        index[cell] = (rating_cell_t) { .id = table->ids[slot], .slot = slot + 1 };
+    }
+
+    free(table->index);
+    table->index      = index;
+    table->index_mask = mask;
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Order Statistics
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied uint32_t rating_bucket_(copied f32 rating)
+{
+    if (!(rating > 0.0f))
+    {
+        return 0;
+    }
+    if (rating >= cast(RATING_BUCKETS - 1, f32))
+    {
+        return RATING_BUCKETS - 1;
+    }
+    return cast(rating, uint32_t);
+}
+
+/* Rebuilds the tree from the histogram in O(buckets): each node passes its sum to its parent. */
+static void rating_fenwick_build_(borrowed rating_table_t * table)
+{
+    if (!table->stale)
+    {
+        return;
+    }
+
+    table->buckets[0] = 0;
+    memcpy(&table->buckets[1], table->counts, RATING_BUCKETS * sizeof(uint32_t));
+    for (uint32_t i = 1; i <= RATING_BUCKETS; i++)
+    {
+        copied uint32_t parent = i + (i & (~i + 1));
+        if (parent <= RATING_BUCKETS)
+        {
+            table->buckets[parent] += table->buckets[i];
+        }
+    }
+    table->stale = false;
+}
+
+/* Players in buckets [0, bucket]. */
+static copied uint32_t rating_fenwick_prefix_(borrowed const rating_table_t * table, copied uint32_t bucket)
+{
+    copied uint32_t sum = 0;
+    for (uint32_t i = bucket + 1; i > 0; i -= i & (~i + 1))
+    {
+        sum += table->buckets[i];
+    }
+    return sum;
+}
+
+/* Smallest bucket whose prefix count reaches `rank` (1-based). */
+static copied uint32_t rating_fenwick_search_(borrowed const rating_table_t * table, copied uint32_t rank)
+{
+    copied uint32_t pos = 0;
+    for (uint32_t step = RATING_BUCKETS; step > 0; step >>= 1)
+    {
+        if (pos + step <= RATING_BUCKETS && table->buckets[pos + step] < rank)
+        {
+            pos  += step;
+            rank -= table->buckets[pos];
+        }
+    }
+    return pos;     /* 0-based bucket = 1-based position - 1 */
+}
+
+static copied int rating_compare_desc_(borrowed const void * lhs, borrowed const void * rhs)
+{
+    copied f32 a = cast(lhs, const rating_rank_t *)->rating;
+    copied f32 b = cast(rhs, const rating_rank_t *)->rating;
+    return (a < b) - (a > b);
+}
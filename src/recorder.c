@@ -0,0 +1,265 @@
+#include "recorder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "monotonic.h"
+
+#define RECORDER_IDLE_NS    (10 * 1000 * 1000)  /* writer naps this long when the ring is empty */
+#define RECORDER_EVENT_MAX  (64)                /* JSON around one event's data */
+
+#define DEFAULT_ROWS        (24)
+#define DEFAULT_COLS        (80)
+
+/* Ring entry header, the output bytes follow it */
+typedef struct {
+    copied uint64_t time_ns;
+    copied uint32_t len;
+    copied uint32_t reserved;
+} recorder_entry_t;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void          * recorder_writer_(borrowed void * arg);
+static copied bool     recorder_drain_(borrowed recorder_t * recorder);
+static void            recorder_flush_(borrowed recorder_t * recorder);
+static void            recorder_ring_put_(borrowed recorder_t * recorder, copied uint64_t at, borrowed const void * data, copied size_t len);
+static void            recorder_ring_get_(borrowed const recorder_t * recorder, copied uint64_t at, borrowed void * data, copied size_t len);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Lifecycle
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool recorder_open(borrowed recorder_t * recorder, borrowed const char * path, copied int out)
+{
+    memset(recorder, 0, sizeof(*recorder));
+    recorder->fd    = -1;
+    recorder->ring  = malloc(RECORDER_RING);
+    recorder->batch = malloc(RECORDER_BATCH);
+    if (!recorder->ring || !recorder->batch)
+    {
+        recorder_close(recorder);
+        return false;
+    }
+
+    recorder->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (recorder->fd < 0)
+    {
+        recorder_close(recorder);
+        return false;
+    }
+
+    copied struct winsize ws = { 0 };
+    if (ioctl(out, TIOCGWINSZ, &ws) < 0 || ws.ws_row == 0 || ws.ws_col == 0)
+    {
+        ws.ws_row = DEFAULT_ROWS;
+        ws.ws_col = DEFAULT_COLS;
+    }
+
+    recorder->used = cast(snprintf(recorder->batch, RECORDER_BATCH,
+                                   "{\"version\": 2, \"width\": %u, \"height\": %u, \"timestamp\": %lld}\n",
+                                   ws.ws_col, ws.ws_row, cast(time(nil), long long)), size_t);
+    recorder_flush_(recorder);
+    recorder->start_ns = monotonic_ns();
+
+    if (0 != pthread_create(&recorder->thread, nil, recorder_writer_, recorder))
+    {
+        recorder_close(recorder);
+        return false;
+    }
+    recorder->running = true;
+    return true;
+}
+
+void recorder_close(borrowed recorder_t * recorder)
+{
+    if (recorder->running)
+    {
+        atomic_store_explicit(&recorder->stop, true, memory_order_release);
+        pthread_join(recorder->thread, nil);
+        recorder->running = false;
+    }
+    if (recorder->dropped > 0)
+    {
+        fprintf(stderr, "rps: recording lost %llu bytes of output\n", cast(recorder->dropped, unsigned long long));
+    }
+    if (recorder->fd >= 0)
+    {
+        close(recorder->fd);
+    }
+    free(recorder->ring);
+    free(recorder->batch);
+    memset(recorder, 0, sizeof(*recorder));
+    recorder->fd = -1;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Producer (session thread)
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void recorder_capture(borrowed void * context, borrowed const struct iovec * iov, copied int count)
+{
+    borrowed recorder_t * recorder = context;
+    if (!recorder->running)
+    {
+        return;
+    }
+
+    copied recorder_entry_t entry = { .time_ns = monotonic_ns(), .len = 0 };
+    for (int i = 0; i < count; i++)
+    {
+        entry.len += cast(iov[i].iov_len, uint32_t);
+    }
+
+    copied uint64_t head = atomic_load_explicit(&recorder->head, memory_order_relaxed);
+    copied uint64_t tail = atomic_load_explicit(&recorder->tail, memory_order_acquire);
+    copied size_t   need = sizeof(entry) + entry.len;
+    if (need > RECORDER_RING - (head - tail))
+    {
+        recorder->dropped += entry.len;
+        return;
+    }
+
+    recorder_ring_put_(recorder, head, &entry, sizeof(entry));
+    copied uint64_t at = head + sizeof(entry);
+    for (int i = 0; i < count; i++)
+    {
+        recorder_ring_put_(recorder, at, iov[i].iov_base, iov[i].iov_len);
+        at += iov[i].iov_len;
+    }
+    atomic_store_explicit(&recorder->head, at, memory_order_release);
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Consumer (writer thread)
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void * recorder_writer_(borrowed void * arg)
+{
+    borrowed recorder_t * recorder = arg;
+
+    copied const struct timespec nap = { .tv_sec = 0, .tv_nsec = RECORDER_IDLE_NS };
+    while (!atomic_load_explicit(&recorder->stop, memory_order_acquire))
+    {
+        if (!recorder_drain_(recorder))
+        {
+            nanosleep(&nap, nil);
+        }
+    }
+
+    /* the producer is done by now: whatever is queued is all there is */
+    recorder_drain_(recorder);
+    return nil;
+}
+
+/* Turns every queued entry into an event line. Returns false if there was none. */
+static copied bool recorder_drain_(borrowed recorder_t * recorder)
+{
+    copied uint64_t tail = atomic_load_explicit(&recorder->tail, memory_order_relaxed);
+    copied uint64_t head = atomic_load_explicit(&recorder->head, memory_order_acquire);
+    if (tail == head)
+    {
+        return false;
+    }
+
+    while (tail != head)
+    {
+        copied recorder_entry_t entry;
+        recorder_ring_get_(recorder, tail, &entry, sizeof(entry));
+        tail += sizeof(entry);
+
+        if (recorder->used + RECORDER_EVENT_MAX > RECORDER_BATCH)
+        {
+            recorder_flush_(recorder);
+        }
+        copied f64 seconds = cast(entry.time_ns - recorder->start_ns, f64) * 1e-9;
+        recorder->used += cast(snprintf(recorder->batch + recorder->used, RECORDER_EVENT_MAX, "[%.6f, \"o\", \"", seconds), size_t);
+
+        for (uint32_t i = 0; i < entry.len; i++, tail++)
+        {
+            /* worst case is a 6-byte \u00XX escape, plus the closing "]\n */
+            if (recorder->used + 6 + 3 > RECORDER_BATCH)
+            {
+                recorder_flush_(recorder);
+            }
+
+            copied uint8_t c = recorder->ring[tail & (RECORDER_RING - 1)];
+            borrowed char * p = recorder->batch + recorder->used;
+            if (c == '"' || c == '\\')
+            {
+                p[0] = '\\';
+                p[1] = cast(c, char);
+                recorder->used += 2;
+            }
+            else if (c < 0x20 || c == 0x7f)
+            {
+                memcpy(p, "\\u00", 4);
+                p[4] = "0123456789abcdef"[c >> 4];
+                p[5] = "0123456789abcdef"[c & 0xf];
+                recorder->used += 6;
+            }
+            else
+            {
+                p[0] = cast(c, char);
+                recorder->used += 1;
+            }
+        }
+        memcpy(recorder->batch + recorder->used, "\"]\n", 3);
+        recorder->used += 3;
+    }
+
+    /* hand the space back before the slow part, the disk write */
+    atomic_store_explicit(&recorder->tail, tail, memory_order_release);
+    recorder_flush_(recorder);
+    return true;
+}
+
+static void recorder_flush_(borrowed recorder_t * recorder)
+{
+    borrowed const char * p    = recorder->batch;
+    copied   size_t       left = recorder->used;
+    while (left > 0)
+    {
+        copied ssize_t n = write(recorder->fd, p, left);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            break;      /* a full disk loses the recording, never the game */
+        }
+        p    += n;
+        left -= cast(n, size_t);
+    }
+    recorder->used = 0;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/* Copies `len` bytes into the ring at position `at`, wrapping around its end. */
+static void recorder_ring_put_(borrowed recorder_t * recorder, copied uint64_t at, borrowed const void * data, copied size_t len)
+{
+    copied size_t offset = cast(at & (RECORDER_RING - 1), size_t);
+    copied size_t first  = (len < RECORDER_RING - offset) ? len : RECORDER_RING - offset;
+    memcpy(recorder->ring + offset, data, first);
+    memcpy(recorder->ring, cast(data, const uint8_t *) + first, len - first);
+}
+
+static void recorder_ring_get_(borrowed const recorder_t * recorder, copied uint64_t at, borrowed void * data, copied size_t len)
+{
+    copied size_t offset = cast(at & (RECORDER_RING - 1), size_t);
+    copied size_t first  = (len < RECORDER_RING - offset) ? len : RECORDER_RING - offset;
+    memcpy(data, recorder->ring + offset, first);
+    memcpy(cast(data, uint8_t *) + first, recorder->ring, len - first);
+}
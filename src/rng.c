@@ -0,0 +1,61 @@
+#include "rng.h"
+
+#include <time.h>
+#include <unistd.h>
+
+#define PCG_MULTIPLIER      (6364136223846793005ull)
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void rng_seed(borrowed rng_t * rng, copied uint64_t seed, copied uint64_t stream)
+{
+    rng->state = 0;
+    rng->inc   = (stream << 1) | 1;
+    rng_next(rng);
+    rng->state += seed;
+    rng_next(rng);
+}
+
+copied uint32_t rng_next(borrowed rng_t * rng)
+{
+    copied uint64_t old = rng->state;
+    rng->state = old * PCG_MULTIPLIER + rng->inc;
+
+    copied uint32_t xorshifted = cast(((old >> 18) ^ old) >> 27, uint32_t);
+    copied uint32_t rot        = cast(old >> 59, uint32_t);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+copied uint32_t rng_below(borrowed rng_t * rng, copied uint32_t bound)
+{
+    /* Lemire: multiply into 64 bits, reject the few low products that would bias */
+    copied uint64_t product   = cast(rng_next(rng), uint64_t) * bound;
+    copied uint32_t low       = cast(product, uint32_t);
+    if (low < bound)
+    {
+        copied uint32_t threshold = (-bound) % bound;
+        while (low < threshold)
+        {
+            product = cast(rng_next(rng), uint64_t) * bound;
+            low     = cast(product, uint32_t);
+        }
+    }
+    return cast(product >> 32, uint32_t);
+}
+
+void rng_moves(borrowed rng_t * rng, borrowed uint8_t * out, copied uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        out[i] = cast(rng_below(rng, 3), uint8_t);
+    }
+}
+
+copied uint64_t rng_entropy()
+{
+    copied struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (cast(ts.tv_sec, uint64_t) * 1000000000ull + cast(ts.tv_nsec, uint64_t)) ^ (cast(getpid(), uint64_t) << 32);
+}
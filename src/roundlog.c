@@ -0,0 +1,128 @@
+#include "roundlog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define ROUNDLOG_PATH_MAX   (4096)
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool roundlog_create_(borrowed const char * path);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool roundlog_path(borrowed char * buf, copied size_t size)
+{
+    borrowed const char * env = getenv(ROUNDLOG_ENV);
+    if (env && env[0])
+    {
+        return cast(snprintf(buf, size, "%s", env), size_t) < size;
+    }
+
+    borrowed const char * home = getenv("HOME");
+    if (!home || !home[0])
+    {
+        return false;
+    }
+    return cast(snprintf(buf, size, "%s/%s", home, ROUNDLOG_FILENAME), size_t) < size;
+}
+
+copied bool roundlog_open(borrowed roundlog_t * log)
+{
+    log->fd = -1;
+
+    copied char path[ROUNDLOG_PATH_MAX];
+    if (!roundlog_path(path, sizeof(path)))
+    {
+        return false;
+    }
+
+    if (access(path, F_OK) < 0 && !roundlog_create_(path))
+    {
+        return false;
+    }
+
+    log->fd = open(path, O_WRONLY | O_APPEND | O_CLOEXEC);
+    return log->fd >= 0;
+}
+
+void roundlog_append(borrowed roundlog_t * log, borrowed const roundlog_record_t * record)
+{
+    if (log->fd < 0)
+    {
+        return;
+    }
+
+    copied ssize_t n;
+    do
+    {
+        n = write(log->fd, record, sizeof(*record));
+    } while (n < 0 && errno == EINTR);
+}
+
+copied bool roundlog_read_header(copied int fd)
+{
+    copied roundlog_header_t header;
+    copied ssize_t           n;
+    do
+    {
+        n = read(fd, &header, sizeof(header));
+    } while (n < 0 && errno == EINTR);
+
+    return n == sizeof(header)
+        && 0 == memcmp(header.magic, ROUNDLOG_MAGIC, sizeof(header.magic))
+        && header.version     == ROUNDLOG_VERSION
+        && header.record_size == sizeof(roundlog_record_t);
+}
+
+void roundlog_close(borrowed roundlog_t * log)
+{
+    if (log->fd >= 0)
+    {
+        close(log->fd);
+    }
+    log->fd = -1;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/*
+ * Writes the header to a private temporary file and links it into place, so nobody
+ * ever appends to a log without a header. Losing the race to another process is fine.
+ */
+static copied bool roundlog_create_(borrowed const char * path)
+{
+    copied char temp[ROUNDLOG_PATH_MAX + 32];
+    if (cast(snprintf(temp, sizeof(temp), "%s.tmp.%ld", path, cast(getpid(), long)), size_t) >= sizeof(temp))
+    {
+        return false;
+    }
+
+    copied int fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    copied roundlog_header_t header = {
+        .magic       = ROUNDLOG_MAGIC,
+        .version     = ROUNDLOG_VERSION,
+        .record_size = sizeof(roundlog_record_t),
+    };
+    copied bool written = sizeof(header) == write(fd, &header, sizeof(header));
+    close(fd);
+
+    copied bool linked = written && (link(temp, path) == 0 || errno == EEXIST);
+    unlink(temp);
+    return linked;
+}
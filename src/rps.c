@@ -0,0 +1,94 @@
+#include "rps.h"
+
+#include "crayon.h"
+#include "unicode.h"
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Emoji Assets
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+asset_t rocks[rocks_count] = {
+    ASSET("✊"),
+    ASSET("👊"),
+    ASSET("🪨"),
+};
+
+asset_t papers[papers_count] = {
+    ASSET("✋"),
+    ASSET("🫱"),
+    ASSET("📜"),
+};
+
+asset_t scissors[scissors_count] = {
+    ASSET("✌️"),
+    ASSET("✂️"),
+};
+
+asset_t trophy    = ASSET("🏆");
+asset_t attention = ASSET("👀");
+asset_t defeated  = ASSET("😵");
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Messages
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+asset_t messages[msg_count] = {
+    [msg_banner]            = ASSET(CRAYON_TO_BOLD("=== Rock Paper Scissors ===")),
+    [msg_hint]              = ASSET(CRAYON_TO_DIM("Ctrl-Q to quit anytime")),
+    [msg_styles_title]      = ASSET("=== Choose Your Styles ==="),
+    [msg_rock_style]        = ASSET("Rock style:     "),
+    [msg_paper_style]       = ASSET("Paper style:    "),
+    [msg_scissors_style]    = ASSET("Scissors style: "),
+    [msg_your_move]         = ASSET("Your move: "),
+    [msg_you]               = ASSET("You:      "),
+    [msg_computer]          = ASSET("Computer: "),
+    [msg_opponent]          = ASSET("Opponent: "),
+    [msg_waiting]           = ASSET(CRAYON_TO_DIM("Waiting for your opponent...")),
+    [msg_opponent_left]     = ASSET("Your opponent left."),
+    [msg_shake_rock]        = ASSET("Rock… "),
+    [msg_shake_paper]       = ASSET("Paper… "),
+    [msg_shake_scissors]    = ASSET("Scissors… "),
+    [msg_shake_shoot]       = ASSET(CRAYON_TO_BOLD("Shoot!")),
+    [msg_rock]              = ASSET("Rock"),
+    [msg_paper]             = ASSET("Paper"),
+    [msg_scissors]          = ASSET("Scissors"),
+    [msg_win]               = ASSET(BLANK CRAYON_TO_GREEN("You win!")),
+    [msg_lose]              = ASSET(BLANK CRAYON_TO_RED("You lose!")),
+    [msg_draw]              = ASSET(BLANK CRAYON_TO_YELLOW("It's a draw!")),
+    [msg_play_again]        = ASSET("Play again? [Y/n] "),
+    [msg_yes]               = ASSET("Yes"),
+    [msg_no]                = ASSET("No"),
+    [msg_thanks]            = ASSET("Thanks for playing!" CRLF),
+    [msg_rounds]            = ASSET("Rounds: "),
+    [msg_wins]              = ASSET("   Wins: "),
+    [msg_losses]            = ASSET("   Losses: "),
+    [msg_draws]             = ASSET("   Draws: "),
+    [msg_rating]            = ASSET("   Rating: "),
+    [msg_reversed]          = ASSET(REVERSED),
+    [msg_endcrayon]         = ASSET(ENDCRAYON),
+    [msg_blank]             = ASSET(BLANK),
+    [msg_crlf]              = ASSET(CRLF),
+};
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Measurement
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void assets_measure_(borrowed asset_t * assets, copied size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        assets[i].columns = unicode_display_width(assets[i].bytes, assets[i].byte_len);
+    }
+}
+
+void assets_measure()
+{
+    assets_measure_(rocks, rocks_count);
+    assets_measure_(papers, papers_count);
+    assets_measure_(scissors, scissors_count);
+    assets_measure_(&trophy, 1);
+    assets_measure_(&attention, 1);
+    assets_measure_(&defeated, 1);
+    assets_measure_(messages, msg_count);
+}
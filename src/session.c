@@ -0,0 +1,875 @@
+#include "session.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "rps.h"
+#include "bandit.h"
+#include "animation.h"
+#include "keys.h"
+#include "metrics.h"
+
+#define loop for(;;)
+
+/* Countdown: 4 beats of "Rock… Paper… Scissors… Shoot!" with both fists shaking */
+#define SHAKE_BEAT      (ANIMATION_FPS * 3 / 10)
+#define SHAKE_FRAMES    (4 * SHAKE_BEAT)
+
+/* Reveal: the opponent's hand rolls through the moves, then settles and the verdict shows */
+#define ROLL_STEP       (2)
+#define ROLL_FRAMES     (ANIMATION_FPS * 2 / 5)
+#define REVEAL_FRAMES   (ROLL_FRAMES + ANIMATION_FPS / 5)
+
+#define KEY_QUIT        (ctrl_mask | 'q')
+#define KEY_INTERRUPT   (ctrl_mask | 'c')   /* raw mode turns Ctrl-C into a key */
+
+/* How long a duel waits on its peer before looking at the player's keys again */
+#define DUEL_SLICE_MS   (20)
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void          session_paint_region_(borrowed void * context, copied region_id_t id, borrowed const region_t * region);
+static void          session_show_status_(borrowed rps_session_t * s, borrowed const asset_t * message, borrowed const asset_t * answer);
+static copied key_t  session_next_key_(borrowed rps_session_t * s);
+static copied int8_t session_choose_item_(borrowed rps_session_t * s, copied int8_t line, borrowed const asset_t * prompt, borrowed const asset_t * items, copied int8_t count);
+static void          session_display_result_(borrowed rps_session_t * s, copied move_t player, copied move_t computer, copied result_t result);
+static copied bool   session_duel_exchange_(borrowed rps_session_t * s, copied move_t player_move, borrowed move_t * opponent_move);
+static copied uint8_t session_duel_recv_(borrowed rps_session_t * s);
+static void          session_record_round_(borrowed rps_session_t * s, copied move_t player, copied move_t computer, copied result_t result);
+static void *        session_ahead_main_(borrowed void * context);
+static void          session_ahead_request_(borrowed rps_session_t * s);
+static copied move_t session_ahead_take_(borrowed rps_session_t * s);
+static void          session_ahead_stop_(borrowed rps_session_t * s);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Lifecycle
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool rps_session_init(borrowed rps_session_t * s, copied int in, copied int out, copied uint64_t seed)
+{
+    memset(s, 0, sizeof(*s));
+    terminal_init(&s->terminal, in, out);
+    profile_init(&s->profile);
+    sketch_context_init(&s->sketch);
+    s->seed                = seed;
+    s->target_win_rate     = BANDIT_TARGET;
+    s->roundlog.fd         = -1;
+    s->recorder.fd         = -1;
+    s->broadcast.listen_fd = -1;
+
+    if (!history_init(&s->history, HISTORY_WINDOW) || !rating_init(&s->ratings, 2))
+    {
+        rps_session_fin(s);
+        return false;
+    }
+    return true;
+}
+
+void rps_session_fin(borrowed rps_session_t * s)
+{
+    terminal_leave_raw_mode(&s->terminal);
+    session_ahead_stop_(s);
+    history_free(&s->history);
+    rating_free(&s->ratings);
+    roundlog_close(&s->roundlog);
+    strategy_destroy(&s->opponent);
+    bot_unload(&s->bot);
+    broadcast_close(&s->broadcast);
+    duel_close(&s->duel);
+
+    /* last, so the recording ends with the terminal restored */
+    terminal_fin(&s->terminal);
+    terminal_tap(&s->terminal, nil, nil);
+    recorder_close(&s->recorder);
+}
+
+copied bool rps_session_load_opponent(borrowed rps_session_t * s, borrowed const char * name, borrowed const char * bot_path, borrowed const char * table_path, borrowed const char ** error)
+{
+    copied strategy_spec_t spec = {
+        .name            = name,
+        .bot_path        = bot_path,
+        .table_path      = table_path,
+        .seed            = s->seed,
+        .target_win_rate = s->target_win_rate,
+    };
+    return strategy_load(&s->opponent, &s->bot, &spec, error);
+}
+
+copied bool rps_session_think_ahead(borrowed rps_session_t * s)
+{
+    if (s->ahead.running)
+    {
+        return true;
+    }
+    if (0 != pthread_mutex_init(&s->ahead.lock, nil))
+    {
+        return false;
+    }
+    if (0 != pthread_cond_init(&s->ahead.wake, nil))
+    {
+        pthread_mutex_destroy(&s->ahead.lock);
+        return false;
+    }
+    if (0 != pthread_create(&s->ahead.thread, nil, session_ahead_main_, s))
+    {
+        pthread_cond_destroy(&s->ahead.wake);
+        pthread_mutex_destroy(&s->ahead.lock);
+        return false;
+    }
+    s->ahead.running = true;
+    return true;
+}
+
+copied bool rps_session_start(borrowed rps_session_t * s, copied bool choose_styles_again)
+{
+    borrowed profile_t * profile = &s->profile;
+    if (!s->ephemeral)
+    {
+        profile_load(profile);
+    }
+
+    copied bool styles_valid = 0 <= profile->rock_style    && profile->rock_style    < rocks_count
+                            && 0 <= profile->paper_style   && profile->paper_style   < papers_count
+                            && 0 <= profile->scissor_style && profile->scissor_style < scissors_count;
+    if (!styles_valid || choose_styles_again)
+    {
+        profile->rock_style    = 0;
+        profile->paper_style   = 0;
+        profile->scissor_style = 0;
+        profile->styles_chosen = false;
+    }
+
+    s->player_id   = rating_id(PROFILE_PLAYER);
+    s->opponent_id = rating_id(s->duel.shm ? "duel" : s->opponent.name);
+    rating_add(&s->ratings, s->player_id, profile->rating, profile->deviation, cast(profile->rated_games, uint32_t));
+    borrowed const profile_opponent_t * opponent = profile_opponent(profile, s->opponent_id);
+    rating_add(&s->ratings, s->opponent_id, opponent->rating, opponent->deviation, opponent->games);
+    roundlog_open(&s->roundlog);
+
+    if (!terminal_enter_raw_mode(&s->terminal))
+    {
+        return false;
+    }
+    terminal_screen_enter(&s->terminal);
+    layout_init(&s->layout, &s->terminal, session_paint_region_, s);
+    layout_render(&s->layout);
+    metrics_add(metric_sessions_started, 1);
+    metrics_add(metric_sessions_active, 1);
+    return true;
+}
+
+void rps_session_stop(borrowed rps_session_t * s)
+{
+    /* rounds only touch the copy in memory, so a result never waits for the disk */
+    if (!s->ephemeral)
+    {
+        profile_save(&s->profile);
+    }
+
+    /* the alternate screen goes away with everything on it, say goodbye on the main one */
+    terminal_screen_leave(&s->terminal);
+    if (s->status.message == &messages[msg_opponent_left])
+    {
+        copied struct iovec iov[2] = { IOV(messages[msg_opponent_left]), IOV(messages[msg_crlf]) };
+        terminal_writev(&s->terminal, iov, 2);
+    }
+    terminal_writev(&s->terminal, &IOV(messages[msg_thanks]), 1);
+    terminal_leave_raw_mode(&s->terminal);
+    metrics_add(metric_sessions_active, -1);
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Game Flow
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void rps_session_choose_styles(borrowed rps_session_t * s)
+{
+    session_show_status_(s, &messages[msg_styles_title], nil);
+
+    copied int8_t rock    = session_choose_item_(s, 0, &messages[msg_rock_style], rocks, rocks_count);
+    copied int8_t paper   = s->quit ? 0 : session_choose_item_(s, 1, &messages[msg_paper_style], papers, papers_count);
+    copied int8_t scissor = s->quit ? 0 : session_choose_item_(s, 2, &messages[msg_scissors_style], scissors, scissors_count);
+    if (s->quit)
+    {
+        return;
+    }
+
+    s->profile.rock_style    = rock;
+    s->profile.paper_style   = paper;
+    s->profile.scissor_style = scissor;
+    s->profile.styles_chosen = true;
+    if (!s->ephemeral)
+    {
+        profile_save(&s->profile);
+    }
+
+    s->picker.lines = 0;
+    layout_invalidate(&s->layout, region_picker);
+    session_show_status_(s, nil, nil);
+}
+
+void rps_session_run(borrowed rps_session_t * s)
+{
+    if (!s->profile.styles_chosen)
+    {
+        rps_session_choose_styles(s);
+    }
+
+    while (!s->quit && rps_session_play_round(s) && rps_session_play_again(s))
+    {
+    }
+}
+
+copied bool rps_session_play_round(borrowed rps_session_t * s)
+{
+    copied asset_t moves[3] = {
+        rocks[s->profile.rock_style],
+        papers[s->profile.paper_style],
+        scissors[s->profile.scissor_style],
+    };
+
+    /* the computer's move never depends on the player's, so it can be chosen meanwhile */
+    if (!s->duel.shm)
+    {
+        session_ahead_request_(s);
+    }
+
+    copied move_t player_move = cast(session_choose_item_(s, 0, &messages[msg_your_move], moves, 3), move_t);
+    if (s->quit)
+    {
+        /* let a waiting duel peer know instead of leaving it hanging */
+        if (s->duel.shm)
+        {
+            duel_send(&s->duel, DUEL_QUIT);
+        }
+        return false;
+    }
+
+    copied move_t computer_move = move_rock;
+    if (s->duel.shm)
+    {
+        if (!session_duel_exchange_(s, player_move, &computer_move))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        computer_move = session_ahead_take_(s);
+    }
+    copied result_t result = judge(player_move, computer_move);
+    metrics_add(metric_rounds_draw + result, 1);
+
+    history_push(&s->history, player_move, computer_move);
+    sketch_observe(&s->sketch, player_move);
+    strategy_observe(&s->opponent, player_move, computer_move);
+
+    copied broadcast_round_t round = {
+        .round    = s->history.total,
+        .player   = player_move,
+        .computer = computer_move,
+        .result   = result,
+        .styles   = { s->profile.rock_style, s->profile.paper_style, s->profile.scissor_style },
+    };
+    broadcast_publish(&s->broadcast, &round);
+    session_record_round_(s, player_move, computer_move, result);
+    session_display_result_(s, player_move, computer_move, result);
+    return true;
+}
+
+copied bool rps_session_play_again(borrowed rps_session_t * s)
+{
+    copied bool again = false;
+    if (!s->quit)
+    {
+        session_show_status_(s, &messages[msg_play_again], nil);
+        loop
+        {
+            copied key_t key = session_next_key_(s);
+            if (key == 'y' || key == 'Y' || key == key_enter)
+            {
+                session_show_status_(s, &messages[msg_play_again], &messages[msg_yes]);
+                again = true;
+                break;
+            }
+            else if (key == 'n' || key == 'N' || key == KEY_QUIT)
+            {
+                session_show_status_(s, &messages[msg_play_again], &messages[msg_no]);
+                break;
+            }
+        }
+    }
+
+    if (!s->duel.shm)
+    {
+        return again;
+    }
+
+    duel_send(&s->duel, again ? DUEL_AGAIN : DUEL_QUIT);
+    if (!again)
+    {
+        return false;
+    }
+
+    session_show_status_(s, &messages[msg_waiting], nil);
+    copied uint8_t message = session_duel_recv_(s);
+    if (message != DUEL_AGAIN)
+    {
+        if (!s->quit)
+        {
+            session_show_status_(s, &messages[msg_opponent_left], nil);
+        }
+        return false;
+    }
+    session_show_status_(s, nil, nil);
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Input
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/* Blocks for the next key, repainting the screen whenever a resize interrupts the wait.
+ * A closed input reads as Ctrl-Q. */
+static copied key_t session_next_key_(borrowed rps_session_t * s)
+{
+    loop
+    {
+        layout_refresh(&s->layout);
+
+        copied key_t key = keyboard_key_event(&s->terminal);
+        if (key != key_none)
+        {
+            return key;
+        }
+        if (s->terminal.closed)
+        {
+            return KEY_QUIT;
+        }
+    }
+}
+
+static copied uint16_t session_item_offset_(borrowed const asset_t * items, copied int8_t idx)
+{
+    copied uint16_t offset = 0;
+    for (int8_t i = 0; i < idx; i++)
+    {
+        offset += items[i].columns;
+    }
+    return offset;
+}
+
+/* Appends the iovecs painting `item` (reversed when selected) to `iov`, returns the count. */
+static copied int session_item_paint_(borrowed struct iovec * iov, borrowed const asset_t * item, copied bool selected)
+{
+    if (!selected)
+    {
+        iov[0] = IOV(*item);
+        return 1;
+    }
+
+    iov[0] = IOV(messages[msg_reversed]);
+    iov[1] = IOV(*item);
+    iov[2] = IOV(messages[msg_endcrayon]);
+    return 3;
+}
+
+/* Lets the player pick one of `items` on picker line `line`. Ctrl-Q sets `quit` and
+ * returns the item under the cursor. */
+static copied int8_t session_choose_item_(borrowed rps_session_t * s, copied int8_t line, borrowed const asset_t * prompt, borrowed const asset_t * items, copied int8_t count)
+{
+    s->picker.prompts[line]  = prompt;
+    s->picker.counts[line]   = (count < PICKER_ITEMS) ? count : PICKER_ITEMS;
+    s->picker.selected[line] = 0;
+    s->picker.lines          = line + 1;
+    memcpy(s->picker.items[line], items, cast(s->picker.counts[line], size_t) * sizeof(asset_t));
+    layout_invalidate(&s->layout, region_picker);
+    layout_render(&s->layout);
+
+    loop
+    {
+        copied int8_t idx  = s->picker.selected[line];
+        copied int8_t prev = idx;
+
+        copied key_t key = session_next_key_(s);
+        if (key == key_left && idx > 0)
+        {
+            idx--;
+        }
+        else if (key == key_right && idx < s->picker.counts[line] - 1)
+        {
+            idx++;
+        }
+        else if (key == key_enter)
+        {
+            return idx;
+        }
+        else if (key == KEY_QUIT)
+        {
+            s->quit = true;
+            return idx;
+        }
+
+        if (prev == idx)
+        {
+            continue;
+        }
+        s->picker.selected[line] = idx;
+
+        borrowed const region_t * region = layout_region(&s->layout, region_picker);
+        if (line >= region->height)
+        {
+            continue;
+        }
+
+        /* repaint only the two cells whose selection state changed */
+        copied struct iovec iov[2 * 4];
+        copied char         prev_seq[16];
+        copied char         idx_seq[16];
+        copied int          n = 0;
+        copied uint16_t     row = region->row + cast(line, uint16_t);
+        copied uint16_t     col = region->col + prompt->columns;
+
+        iov[n++] = (struct iovec) { .iov_base = prev_seq, .iov_len = layout_goto(prev_seq, row, col + session_item_offset_(s->picker.items[line], prev)) };
+        n += session_item_paint_(&iov[n], &s->picker.items[line][prev], false);
+        iov[n++] = (struct iovec) { .iov_base = idx_seq, .iov_len = layout_goto(idx_seq, row, col + session_item_offset_(s->picker.items[line], idx)) };
+        n += session_item_paint_(&iov[n], &s->picker.items[line][idx], true);
+        terminal_writev(&s->terminal, iov, n);
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Rounds
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/* Exchanges moves with the duel peer. Returns false if the peer has left. */
+static copied bool session_duel_exchange_(borrowed rps_session_t * s, copied move_t player_move, borrowed move_t * opponent_move)
+{
+    session_show_status_(s, &messages[msg_waiting], nil);
+    duel_send(&s->duel, cast(player_move, uint8_t));
+
+    copied uint8_t message = session_duel_recv_(s);
+    if (message >= moves_count)
+    {
+        if (!s->quit)
+        {
+            session_show_status_(s, &messages[msg_opponent_left], nil);
+        }
+        return false;
+    }
+    session_show_status_(s, nil, nil);
+
+    *opponent_move = cast(message, move_t);
+    return true;
+}
+
+/*
+ * Waits for the peer's next message, still serving the player meanwhile: a resize
+ * repaints, and Ctrl-Q, Ctrl-C or a closed input quits, telling the peer.
+ */
+static copied uint8_t session_duel_recv_(borrowed rps_session_t * s)
+{
+    loop
+    {
+        copied int32_t message = duel_recv_timeout(&s->duel, DUEL_SLICE_MS);
+        if (message >= 0)
+        {
+            return cast(message, uint8_t);
+        }
+
+        layout_refresh(&s->layout);
+
+        copied struct pollfd pfd = { .fd = s->terminal.in, .events = POLLIN };
+        if (terminal_poll(&s->terminal, &pfd, 1, 0) <= 0)
+        {
+            continue;
+        }
+        copied key_t key = keyboard_key_event(&s->terminal);
+        if (key == KEY_QUIT || key == KEY_INTERRUPT || s->terminal.closed)
+        {
+            s->quit = true;
+            duel_send(&s->duel, DUEL_QUIT);
+            return DUEL_QUIT;
+        }
+    }
+}
+
+static void session_record_round_(borrowed rps_session_t * s, copied move_t player, copied move_t computer, copied result_t result)
+{
+    borrowed profile_t * profile = &s->profile;
+
+    profile->rounds++;
+    switch (result)
+    {
+        case result_win:    profile->wins++;     break;
+        case result_lose:   profile->losses++;   break;
+        case result_draw:   profile->draws++;    break;
+    }
+
+    copied const f32 scores[3] = { [result_draw] = 0.5f, [result_win] = 1.0f, [result_lose] = 0.0f };
+    copied rating_game_t game  = { .player = s->player_id, .opponent = s->opponent_id, .score = scores[result] };
+    copied int64_t       slot  = rating_find(&s->ratings, s->player_id);
+    copied int64_t       other = rating_find(&s->ratings, s->opponent_id);
+    if (slot >= 0 && other >= 0 && rating_update(&s->ratings, &game))
+    {
+        profile->rating      = s->ratings.ratings[slot];
+        profile->deviation   = s->ratings.deviations[slot];
+        profile->rated_games++;
+
+        borrowed profile_opponent_t * opponent = profile_opponent(profile, s->opponent_id);
+        opponent->rating    = s->ratings.ratings[other];
+        opponent->deviation = s->ratings.deviations[other];
+        opponent->games     = s->ratings.games[other];
+    }
+
+    copied struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    copied roundlog_record_t record = {
+        .time_ns  = cast(now.tv_sec, uint64_t) * 1000000000ull + cast(now.tv_nsec, uint64_t),
+        .round    = cast(s->history.total, uint32_t),
+        .player   = cast(player, uint8_t),
+        .computer = cast(computer, uint8_t),
+        .result   = cast(result, uint8_t),
+    };
+    strncpy(record.strategy, s->duel.shm ? "duel" : s->opponent.name, sizeof(record.strategy));
+    roundlog_append(&s->roundlog, &record);
+}
+
+static void session_paint_outcome_frame_(copied uint32_t frame, borrowed void * context)
+{
+    borrowed rps_session_t * s = context;
+
+    s->outcome.frame = frame;
+    layout_invalidate(&s->layout, region_result);
+    layout_render(&s->layout);
+}
+
+/* Plays one phase of the result animation. Any key skips the rest, Ctrl-Q also quits. */
+static copied bool session_animate_outcome_(borrowed rps_session_t * s, copied outcome_phase_t phase, copied uint32_t frames)
+{
+    s->outcome.phase = phase;
+
+    copied key_t key = animation_play(&s->terminal, &s->layout, frames, ANIMATION_FPS, session_paint_outcome_frame_, s);
+    if (key == KEY_QUIT || s->terminal.closed)
+    {
+        s->quit = true;
+    }
+    return key == key_none;
+}
+
+static void session_display_result_(borrowed rps_session_t * s, copied move_t player, copied move_t computer, copied result_t result)
+{
+    s->outcome.player   = player;
+    s->outcome.computer = computer;
+    s->outcome.result   = result;
+
+    if (!s->instant && session_animate_outcome_(s, outcome_shake, SHAKE_FRAMES))
+    {
+        session_animate_outcome_(s, outcome_reveal, REVEAL_FRAMES);
+    }
+
+    s->outcome.phase = outcome_shown;
+    layout_invalidate(&s->layout, region_result);
+    layout_invalidate(&s->layout, region_scoreboard);
+    layout_render(&s->layout);
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Thinking Ahead
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/*
+ * The worker owns the opponent and the history only between a request and the take that
+ * follows it; the session thread reads keys and paints meanwhile, and touches neither.
+ */
+static void * session_ahead_main_(borrowed void * context)
+{
+    borrowed rps_session_t * s = context;
+    pthread_mutex_lock(&s->ahead.lock);
+    loop
+    {
+        while (!s->ahead.stop && !(s->ahead.pending && !s->ahead.ready))
+        {
+            pthread_cond_wait(&s->ahead.wake, &s->ahead.lock);
+        }
+        if (s->ahead.stop)
+        {
+            break;
+        }
+        pthread_mutex_unlock(&s->ahead.lock);
+
+        copied move_t move = strategy_choose(&s->opponent, &s->history);
+
+        pthread_mutex_lock(&s->ahead.lock);
+        s->ahead.move  = move;
+        s->ahead.ready = true;
+        pthread_cond_broadcast(&s->ahead.wake);
+    }
+    pthread_mutex_unlock(&s->ahead.lock);
+    return nil;
+}
+
+static void session_ahead_request_(borrowed rps_session_t * s)
+{
+    if (!s->ahead.running)
+    {
+        return;
+    }
+    pthread_mutex_lock(&s->ahead.lock);
+    if (!s->ahead.pending)
+    {
+        s->ahead.pending = true;
+        s->ahead.ready   = false;
+        pthread_cond_broadcast(&s->ahead.wake);
+    }
+    pthread_mutex_unlock(&s->ahead.lock);
+}
+
+/* The move asked for at the start of the round, waiting for the worker if it is not done yet. */
+static copied move_t session_ahead_take_(borrowed rps_session_t * s)
+{
+    if (!s->ahead.running)
+    {
+        return strategy_choose(&s->opponent, &s->history);
+    }
+    pthread_mutex_lock(&s->ahead.lock);
+    while (!s->ahead.ready)
+    {
+        pthread_cond_wait(&s->ahead.wake, &s->ahead.lock);
+    }
+    copied move_t move = s->ahead.move;
+    s->ahead.pending = false;
+    s->ahead.ready   = false;
+    pthread_mutex_unlock(&s->ahead.lock);
+    return move;
+}
+
+/* Lets a move being chosen finish, so the opponent can be destroyed after. */
+static void session_ahead_stop_(borrowed rps_session_t * s)
+{
+    if (!s->ahead.running)
+    {
+        return;
+    }
+    pthread_mutex_lock(&s->ahead.lock);
+    s->ahead.stop = true;
+    pthread_cond_broadcast(&s->ahead.wake);
+    pthread_mutex_unlock(&s->ahead.lock);
+
+    pthread_join(s->ahead.thread, nil);
+    pthread_cond_destroy(&s->ahead.wake);
+    pthread_mutex_destroy(&s->ahead.lock);
+    s->ahead.running = false;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Painting
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static borrowed const asset_t * session_move_emoji_(borrowed const rps_session_t * s, copied move_t move)
+{
+    switch (move)
+    {
+        case move_rock:     return &rocks[s->profile.rock_style];
+        case move_paper:    return &papers[s->profile.paper_style];
+        case move_scissors: return &scissors[s->profile.scissor_style];
+    }
+    return &attention;
+}
+
+static borrowed const asset_t * session_move_name_(copied move_t move)
+{
+    switch (move)
+    {
+        case move_rock:     return &messages[msg_rock];
+        case move_paper:    return &messages[msg_paper];
+        case move_scissors: return &messages[msg_scissors];
+    }
+    return &messages[msg_blank];
+}
+
+/* Formats `value` in decimal into `buf` (at least 20 bytes), returns its length. */
+static copied size_t session_format_u64_(borrowed char * buf, copied uint64_t value)
+{
+    copied char   digits[20];
+    copied size_t count = 0;
+    do
+    {
+        digits[count++] = cast('0' + (value % 10), char);
+        value /= 10;
+    } while (value > 0);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        buf[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+/* Appends the cursor jump to `line` of `region` to `iov`, `seq` holds the sequence bytes. */
+static copied int session_line_goto_(borrowed struct iovec * iov, borrowed char * seq, borrowed const region_t * region, copied uint16_t line)
+{
+    iov[0] = (struct iovec) { .iov_base = seq, .iov_len = layout_goto(seq, region->row + line, region->col) };
+    return 1;
+}
+
+static void session_paint_region_(borrowed void * context, copied region_id_t id, borrowed const region_t * region)
+{
+    borrowed rps_session_t   * s       = context;
+    borrowed const profile_t * profile = &s->profile;
+
+    copied struct iovec iov[4 * 16];
+    copied char         seq[4][16];
+    copied char         numbers[5][20];
+    copied int          n = 0;
+
+    switch (id)
+    {
+        case region_header:
+        {
+            n += session_line_goto_(&iov[n], seq[0], region, 0);
+            iov[n++] = IOV(messages[msg_banner]);
+            n += session_line_goto_(&iov[n], seq[1], region, 1);
+            iov[n++] = IOV(messages[msg_hint]);
+        } break;
+
+        case region_picker:
+        {
+            for (int8_t line = 0; line < s->picker.lines && line < region->height; line++)
+            {
+                n += session_line_goto_(&iov[n], seq[line], region, cast(line, uint16_t));
+                iov[n++] = IOV(*s->picker.prompts[line]);
+                for (int8_t i = 0; i < s->picker.counts[line]; i++)
+                {
+                    n += session_item_paint_(&iov[n], &s->picker.items[line][i], i == s->picker.selected[line]);
+                }
+            }
+        } break;
+
+        case region_result:
+        {
+            if (s->outcome.phase == outcome_hidden)
+            {
+                break;
+            }
+
+            copied message_t opponent = s->duel.shm ? msg_opponent : msg_computer;
+
+            if (s->outcome.phase == outcome_shake)
+            {
+                /* one more word per beat; fists up for the first half of a beat, down for the second */
+                copied uint32_t beat = s->outcome.frame / SHAKE_BEAT;
+                copied uint16_t fist = (s->outcome.frame % SHAKE_BEAT < SHAKE_BEAT / 2) ? 1 : 2;
+
+                n += session_line_goto_(&iov[n], seq[0], region, 0);
+                for (uint32_t word = 0; word <= beat && word < 4; word++)
+                {
+                    iov[n++] = IOV(messages[msg_shake_rock + word]);
+                }
+                n += session_line_goto_(&iov[n], seq[fist], region, fist);
+                iov[n++] = IOV(messages[msg_you]);
+                iov[n++] = IOV(rocks[profile->rock_style]);
+                iov[n++] = IOV(messages[msg_blank]);
+                iov[n++] = IOV(messages[msg_blank]);
+                iov[n++] = IOV(messages[opponent]);
+                iov[n++] = IOV(rocks[profile->rock_style]);
+                break;
+            }
+
+            copied bool settled = s->outcome.phase == outcome_shown || s->outcome.frame >= ROLL_FRAMES;
+
+            n += session_line_goto_(&iov[n], seq[0], region, 0);
+            iov[n++] = IOV(messages[msg_you]);
+            iov[n++] = IOV(*session_move_emoji_(s, s->outcome.player));
+            iov[n++] = IOV(messages[msg_blank]);
+            iov[n++] = IOV(*session_move_name_(s->outcome.player));
+
+            n += session_line_goto_(&iov[n], seq[1], region, 1);
+            iov[n++] = IOV(messages[opponent]);
+            if (!settled)
+            {
+                copied move_t rolling = cast((s->outcome.computer + 1 + s->outcome.frame / ROLL_STEP) % moves_count, move_t);
+                iov[n++] = IOV(*session_move_emoji_(s, rolling));
+                break;
+            }
+            iov[n++] = IOV(*session_move_emoji_(s, s->outcome.computer));
+            iov[n++] = IOV(messages[msg_blank]);
+            iov[n++] = IOV(*session_move_name_(s->outcome.computer));
+
+            if (s->outcome.phase != outcome_shown)
+            {
+                break;
+            }
+
+            n += session_line_goto_(&iov[n], seq[3], region, 3);
+            switch (s->outcome.result)
+            {
+                case result_win:
+                    iov[n++] = IOV(trophy);
+                    iov[n++] = IOV(messages[msg_win]);
+                    break;
+                case result_lose:
+                    iov[n++] = IOV(defeated);
+                    iov[n++] = IOV(messages[msg_lose]);
+                    break;
+                case result_draw:
+                    iov[n++] = IOV(attention);
+                    iov[n++] = IOV(messages[msg_draw]);
+                    break;
+            }
+        } break;
+
+        case region_status:
+        {
+            if (!s->status.message)
+            {
+                break;
+            }
+
+            n += session_line_goto_(&iov[n], seq[0], region, 0);
+            iov[n++] = IOV(*s->status.message);
+            if (s->status.answer)
+            {
+                iov[n++] = IOV(*s->status.answer);
+            }
+        } break;
+
+        case region_scoreboard:
+        {
+            copied const uint64_t  values[5] = {
+                profile->rounds, profile->wins, profile->losses, profile->draws,
+                cast(fmaxf(profile->rating, 0.0f) + 0.5f, uint64_t),
+            };
+            copied const message_t labels[5] = { msg_rounds, msg_wins, msg_losses, msg_draws, msg_rating };
+
+            n += session_line_goto_(&iov[n], seq[0], region, 0);
+            for (int i = 0; i < 5; i++)
+            {
+                iov[n++] = IOV(messages[labels[i]]);
+                iov[n++] = (struct iovec) { .iov_base = numbers[i], .iov_len = session_format_u64_(numbers[i], values[i]) };
+            }
+        } break;
+
+        case region_count:
+            break;
+    }
+
+    if (n > 0)
+    {
+        terminal_writev(&s->terminal, iov, n);
+    }
+}
+
+/* Shows `message` (and `answer` after it) on the status line right away. */
+static void session_show_status_(borrowed rps_session_t * s, borrowed const asset_t * message, borrowed const asset_t * answer)
+{
+    s->status.message = message;
+    s->status.answer  = answer;
+    layout_invalidate(&s->layout, region_status);
+    layout_render(&s->layout);
+}
@@ -0,0 +1,404 @@
+/* MAP_ANONYMOUS is not part of POSIX */
+#define _DEFAULT_SOURCE
+
+#include "shard.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "monotonic.h"
+
+#define SHARD_BATCH         (4096)
+#define SEED_SPACING        (0x9e3779b97f4a7c15ull)     /* golden ratio, spreads the shard seeds */
+
+/* The shared mapping and what the parent knows about each worker */
+typedef struct {
+    borrowed const shard_config_t * config;
+    owned    void                 * map;
+    copied   size_t                 size;
+    borrowed shard_header_t       * header;
+    borrowed shard_slot_t         * slots;
+    copied   pid_t                  pids[SHARD_MAX];
+    copied   int                    statuses[SHARD_MAX];   /* from waitpid(), -1 while running */
+} shard_run_t;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool             shard_map_(borrowed shard_run_t * run);
+static void                    shard_worker_(borrowed const shard_config_t * config, borrowed shard_slot_t * slot, copied uint32_t index, copied pid_t parent);
+static copied uint64_t         shard_quota_(borrowed const shard_config_t * config, copied uint32_t index);
+static void                    shard_publish_(borrowed shard_slot_t * slot, borrowed const shard_progress_t * progress);
+static copied shard_progress_t shard_read_(borrowed shard_slot_t * slot);
+static copied shard_progress_t shard_sum_(borrowed const shard_run_t * run);
+static void                    shard_report_(borrowed const shard_run_t * run, copied uint64_t resumed, copied f64 elapsed);
+static borrowed const char   * shard_label_(borrowed const strategy_spec_t * spec);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Parent
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool shard_simulate(borrowed const shard_config_t * config)
+{
+    if (config->shards == 0 || config->shards > SHARD_MAX)
+    {
+        fprintf(stderr, "rps: --shards must be between 1 and %u\n", SHARD_MAX);
+        return false;
+    }
+
+    copied shard_run_t run = { .config = config };
+    if (!shard_map_(&run))
+    {
+        return false;
+    }
+    copied uint64_t resumed = shard_sum_(&run).done;
+
+    /* the workers must not flush a copy of what the parent buffered */
+    fflush(stdout);
+    fflush(stderr);
+
+    /* blocked before the first fork, so an early exit still wakes the wait below */
+    copied sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &chld, nil);
+
+    copied pid_t    parent  = getpid();
+    copied uint32_t running = 0;
+    for (uint32_t i = 0; i < config->shards; i++)
+    {
+        run.statuses[i] = 0;
+        if (shard_read_(&run.slots[i]).done >= shard_quota_(config, i))
+        {
+            atomic_store(&run.slots[i].status, shard_finished);
+            continue;
+        }
+
+        atomic_store(&run.slots[i].status, shard_running);
+        run.pids[i] = fork();
+        if (run.pids[i] == 0)
+        {
+            shard_worker_(config, &run.slots[i], i, parent);
+        }
+        if (run.pids[i] < 0)
+        {
+            fprintf(stderr, "rps: cannot start shard %u: %s\n", i, strerror(errno));
+            run.statuses[i] = 1;
+            continue;
+        }
+        run.statuses[i] = -1;
+        running++;
+    }
+
+    /* watch the slots until every worker is gone */
+    copied bool            live  = isatty(STDERR_FILENO);
+    copied f64             start = monotonic_seconds();
+    copied struct timespec nap   = { .tv_sec = 0, .tv_nsec = SHARD_REPORT_MS * 1000000L };
+    while (running > 0)
+    {
+        sigtimedwait(&chld, nil, &nap);
+
+        copied int   status = 0;
+        copied pid_t pid    = 0;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+        {
+            for (uint32_t i = 0; i < config->shards; i++)
+            {
+                if (run.pids[i] == pid && run.statuses[i] == -1)
+                {
+                    run.statuses[i] = status;
+                    running--;
+                }
+            }
+        }
+
+        if (live)
+        {
+            copied uint64_t done    = shard_sum_(&run).done;
+            copied f64      elapsed = monotonic_seconds() - start;
+            fprintf(stderr, "\rsimulating: %5.1f%%  %llu rounds  %.1fM rounds/s ",
+                    config->rounds ? 100.0 * cast(done, f64) / cast(config->rounds, f64) : 100.0,
+                    cast(done, unsigned long long),
+                    elapsed > 0.0 ? cast(done - resumed, f64) / elapsed * 1e-6 : 0.0);
+        }
+    }
+    copied f64 elapsed = monotonic_seconds() - start;
+    sigprocmask(SIG_UNBLOCK, &chld, nil);
+    if (live)
+    {
+        fprintf(stderr, "\n");
+    }
+
+    copied bool ok = true;
+    for (uint32_t i = 0; i < config->shards; i++)
+    {
+        copied int      status = run.statuses[i];
+        copied uint64_t done   = shard_read_(&run.slots[i]).done;
+        if (atomic_load(&run.slots[i].status) == shard_failed)
+        {
+            fprintf(stderr, "rps: shard %u cannot load its opponent\n", i);
+            ok = false;
+        }
+        else if (WIFSIGNALED(status))
+        {
+            fprintf(stderr, "rps: shard %u killed by signal %d after %llu rounds\n", i, WTERMSIG(status), cast(done, unsigned long long));
+            ok = false;
+        }
+        else if (WIFEXITED(status) && WEXITSTATUS(status) != 0)
+        {
+            fprintf(stderr, "rps: shard %u failed after %llu rounds\n", i, cast(done, unsigned long long));
+            ok = false;
+        }
+    }
+
+    shard_report_(&run, resumed, elapsed);
+    if (!ok && config->checkpoint)
+    {
+        fprintf(stderr, "rps: run the same command again to resume from %s\n", config->checkpoint);
+    }
+
+    munmap(run.map, run.size);
+    return ok;
+}
+
+/* Maps the slots: anonymous, or the checkpoint file, created or resumed. */
+static copied bool shard_map_(borrowed shard_run_t * run)
+{
+    borrowed const shard_config_t * config = run->config;
+    run->size = sizeof(shard_header_t) + cast(config->shards, size_t) * sizeof(shard_slot_t);
+
+    copied shard_header_t expected = {
+        .magic  = SHARD_MAGIC,
+        .rounds = config->rounds,
+        .seed   = config->opponent.seed,
+        .shards = config->shards,
+    };
+    strncpy(expected.opponent, shard_label_(&config->opponent), sizeof(expected.opponent) - 1);
+
+    if (!config->checkpoint)
+    {
+        run->map = mmap(nil, run->size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (run->map == MAP_FAILED)
+        {
+            fprintf(stderr, "rps: out of memory\n");
+            return false;
+        }
+        run->header  = run->map;
+        run->slots   = cast(cast(run->map, char *) + sizeof(shard_header_t), shard_slot_t *);
+        *run->header = expected;
+        return true;
+    }
+
+    copied int fd = open(config->checkpoint, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    copied struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0)
+    {
+        perror(config->checkpoint);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+
+    copied bool fresh = (st.st_size == 0);
+    if (!fresh && cast(st.st_size, size_t) != run->size)
+    {
+        fprintf(stderr, "rps: %s is the checkpoint of another run\n", config->checkpoint);
+        close(fd);
+        return false;
+    }
+    if (fresh && ftruncate(fd, cast(run->size, off_t)) < 0)
+    {
+        perror(config->checkpoint);
+        close(fd);
+        return false;
+    }
+
+    run->map = mmap(nil, run->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (run->map == MAP_FAILED)
+    {
+        perror(config->checkpoint);
+        return false;
+    }
+    run->header = run->map;
+    run->slots  = cast(cast(run->map, char *) + sizeof(shard_header_t), shard_slot_t *);
+
+    if (fresh)
+    {
+        *run->header = expected;
+    }
+    else if (0 != memcmp(run->header, &expected, sizeof(expected)))
+    {
+        fprintf(stderr, "rps: %s is the checkpoint of another run\n", config->checkpoint);
+        munmap(run->map, run->size);
+        return false;
+    }
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Worker
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void shard_worker_(borrowed const shard_config_t * config, borrowed shard_slot_t * slot, copied uint32_t index, copied pid_t parent)
+{
+    /* an orphaned worker would race the next run for its slot */
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    if (getppid() != parent)
+    {
+        _exit(1);
+    }
+
+    copied sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+    sigprocmask(SIG_UNBLOCK, &chld, nil);
+
+    copied shard_progress_t progress = shard_read_(slot);
+    if (atomic_load(&slot->seq) < 2)
+    {
+        memset(&progress, 0, sizeof(progress));
+        rng_seed(&progress.player, config->opponent.seed, RNG_STREAM_SHARD + (cast(index, uint64_t) << 8));
+    }
+    copied uint64_t quota = shard_quota_(config, index);
+
+    copied strategy_spec_t spec = config->opponent;
+    spec.seed += cast(index + 1, uint64_t) * SEED_SPACING;
+
+    copied strategy_t     opponent;
+    copied bot_t          bot   = { 0 };
+    copied history_t      history;
+    borrowed const char * error = nil;
+    if (!strategy_load(&opponent, &bot, &spec, &error) || !history_init(&history, HISTORY_WINDOW))
+    {
+        atomic_store(&slot->status, shard_failed);
+        _exit(2);
+    }
+
+    copied uint8_t computer[SHARD_BATCH];
+    while (progress.done < quota)
+    {
+        copied uint32_t n = (quota - progress.done < SHARD_BATCH) ? cast(quota - progress.done, uint32_t) : SHARD_BATCH;
+        if (n > opponent.batch)
+        {
+            n = opponent.batch;
+        }
+
+        strategy_choose_n(&opponent, &history, n, computer);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            copied move_t player = cast(rng_below(&progress.player, moves_count), move_t);
+            progress.tally[judge(player, cast(computer[i], move_t))]++;
+            history_push(&history, player, cast(computer[i], move_t));
+            strategy_observe(&opponent, player, cast(computer[i], move_t));
+        }
+        progress.done += n;
+
+        /* interactive opponents play batches of one: publish per SHARD_BATCH rounds at most */
+        if (progress.done % SHARD_BATCH < n || progress.done == quota)
+        {
+            shard_publish_(slot, &progress);
+        }
+    }
+
+    atomic_store(&slot->status, shard_finished);
+    _exit(0);
+}
+
+/* The rounds shard `index` plays: an even split, the first ones taking the remainder. */
+static copied uint64_t shard_quota_(borrowed const shard_config_t * config, copied uint32_t index)
+{
+    return config->rounds / config->shards + (index < config->rounds % config->shards ? 1 : 0);
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Slots
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/*
+ * Fills the copy readers are not looking at. `seq` is odd while it does, and its upper
+ * bits count the publishes, the last one in copy[(seq >> 1) & 1]; a worker killed
+ * mid-write thus leaves the previous copy whole for the resume.
+ */
+static void shard_publish_(borrowed shard_slot_t * slot, borrowed const shard_progress_t * progress)
+{
+    copied uint64_t published = atomic_load_explicit(&slot->seq, memory_order_relaxed) >> 1;
+    atomic_store_explicit(&slot->seq, 2 * published + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->copy[(published + 1) & 1] = *progress;
+    atomic_store_explicit(&slot->seq, 2 * published + 2, memory_order_release);
+}
+
+/*
+ * Copies the last published counters. The copy is only overwritten by the publish after
+ * the next, which marks `seq` odd first; seeing `seq` move that far meanwhile means the
+ * copy may be torn, so it is read again.
+ */
+static copied shard_progress_t shard_read_(borrowed shard_slot_t * slot)
+{
+    for (;;)
+    {
+        copied uint64_t         seq      = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        copied shard_progress_t progress = slot->copy[(seq >> 1) & 1];
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->seq, memory_order_relaxed) <= (seq | 1) + 1)
+        {
+            return progress;
+        }
+    }
+}
+
+static copied shard_progress_t shard_sum_(borrowed const shard_run_t * run)
+{
+    copied shard_progress_t sum = { 0 };
+    for (uint32_t i = 0; i < run->config->shards; i++)
+    {
+        copied shard_progress_t p = shard_read_(&run->slots[i]);
+        sum.done += p.done;
+        for (int r = 0; r < 3; r++)
+        {
+            sum.tally[r] += p.tally[r];
+        }
+    }
+    return sum;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void shard_report_(borrowed const shard_run_t * run, copied uint64_t resumed, copied f64 elapsed)
+{
+    copied shard_progress_t sum    = shard_sum_(run);
+    copied uint64_t         played = sum.done - resumed;
+
+    printf("rounds:        %llu of %llu\n", cast(sum.done, unsigned long long), cast(run->config->rounds, unsigned long long));
+    printf("opponent:      %s\n", run->header->opponent);
+    printf("shards:        %u\n", run->config->shards);
+    if (resumed > 0)
+    {
+        printf("resumed:       %llu rounds from %s\n", cast(resumed, unsigned long long), run->config->checkpoint);
+    }
+    printf("opponent wins: %llu\n", cast(sum.tally[result_lose], unsigned long long));
+    printf("player wins:   %llu\n", cast(sum.tally[result_win], unsigned long long));
+    printf("draws:         %llu\n", cast(sum.tally[result_draw], unsigned long long));
+    printf("elapsed:       %.3fs (%.1f ns/round over all shards)\n", elapsed, played ? elapsed * 1e9 / cast(played, f64) : 0.0);
+}
+
+static borrowed const char * shard_label_(borrowed const strategy_spec_t * spec)
+{
+    return spec->bot_path ? spec->bot_path : spec->table_path ? spec->table_path : spec->name;
+}
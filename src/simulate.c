@@ -0,0 +1,129 @@
+#include "simulate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rating.h"
+#include "rng.h"
+#include "perf.h"
+#include "monotonic.h"
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Tournament Loop
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void simulate(borrowed strategy_t * opponent, copied uint64_t rounds, copied uint64_t seed, copied bool perf_counters)
+{
+    copied rng_t rng;
+    rng_seed(&rng, seed, RNG_STREAM_PLAYER);
+
+    copied history_t history;
+    if (!history_init(&history, HISTORY_WINDOW))
+    {
+        fprintf(stderr, "rps: out of memory\n");
+        return;
+    }
+
+    /* the random player and the opponent, rated as the match goes */
+    copied rating_table_t ratings;
+    if (!rating_init(&ratings, 2))
+    {
+        fprintf(stderr, "rps: out of memory\n");
+        history_free(&history);
+        return;
+    }
+    copied uint64_t player_id   = rating_id(SIMULATE_PLAYER);
+    copied uint64_t opponent_id = rating_id(opponent->name);
+
+    static rating_game_t games[SIMULATE_BATCH];
+    copied f32 const     scores[3] = { [result_draw] = 0.5f, [result_win] = 1.0f, [result_lose] = 0.0f };
+
+    copied uint8_t  player[SIMULATE_BATCH];
+    copied uint8_t  computer[SIMULATE_BATCH];
+    copied uint8_t  results[SIMULATE_BATCH];
+    copied uint64_t tally[3] = { 0 };   /* indexed by result_t, player's view */
+
+    /*
+     * Counters the system refuses are reported as unavailable, the run goes on regardless.
+     * They only count the opponent choosing and learning and the judging; the random
+     * player and the rating pass run paused, a whole chunk at a time, so pausing costs a
+     * few syscalls per SIMULATE_BATCH rounds whatever the opponent's batch.
+     */
+    copied perf_counters_t perf;
+    if (perf_counters)
+    {
+        perf_counters_open(&perf);
+        perf_counters_start(&perf);
+        perf_counters_pause(&perf);
+    }
+
+    copied f64 start = monotonic_seconds();
+    for (uint64_t done = 0; done < rounds; )
+    {
+        copied uint32_t chunk = (rounds - done < SIMULATE_BATCH) ? cast(rounds - done, uint32_t) : SIMULATE_BATCH;
+        for (uint32_t i = 0; i < chunk; i++)
+        {
+            player[i] = cast(rng_below(&rng, moves_count), uint8_t);
+        }
+
+        if (perf_counters)
+        {
+            perf_counters_resume(&perf);
+        }
+        for (uint32_t at = 0; at < chunk; )
+        {
+            copied uint32_t n = (chunk - at < opponent->batch) ? chunk - at : opponent->batch;
+
+            /* the whole batch is committed against the history as of its first round */
+            strategy_choose_n(opponent, &history, n, &computer[at]);
+
+            for (uint32_t i = at; i < at + n; i++)
+            {
+                copied result_t result = judge(cast(player[i], move_t), cast(computer[i], move_t));
+                results[i] = cast(result, uint8_t);
+                tally[result]++;
+                history_push(&history, cast(player[i], move_t), cast(computer[i], move_t));
+                strategy_observe(opponent, cast(player[i], move_t), cast(computer[i], move_t));
+            }
+            at += n;
+        }
+        if (perf_counters)
+        {
+            perf_counters_pause(&perf);
+        }
+
+        for (uint32_t i = 0; i < chunk; i++)
+        {
+            games[i] = (rating_game_t) { .player = player_id, .opponent = opponent_id, .score = scores[results[i]] };
+        }
+        rating_update_batch(&ratings, games, chunk);
+        done += chunk;
+    }
+    copied f64 elapsed = monotonic_seconds() - start;
+    if (perf_counters)
+    {
+        perf_counters_stop(&perf);
+    }
+
+    printf("rounds:        %llu\n", cast(rounds, unsigned long long));
+    printf("opponent:      %s\n", opponent->name);
+    printf("opponent wins: %llu\n", cast(tally[result_lose], unsigned long long));
+    printf("player wins:   %llu\n", cast(tally[result_win], unsigned long long));
+    printf("draws:         %llu\n", cast(tally[result_draw], unsigned long long));
+    copied int64_t p = rating_find(&ratings, player_id);
+    copied int64_t o = rating_find(&ratings, opponent_id);
+    if (p >= 0 && o >= 0)
+    {
+        printf("ratings:       player %.0f ± %.0f, opponent %.0f ± %.0f\n",
+               ratings.ratings[p], ratings.deviations[p], ratings.ratings[o], ratings.deviations[o]);
+    }
+    printf("elapsed:       %.3fs (%.1f ns/round)\n", elapsed, rounds ? elapsed * 1e9 / cast(rounds, f64) : 0.0);
+    if (perf_counters)
+    {
+        perf_counters_report(&perf, rounds, stdout);
+        perf_counters_close(&perf);
+    }
+
+    rating_free(&ratings);
+    history_free(&history);
+}
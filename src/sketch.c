@@ -0,0 +1,183 @@
+#include "sketch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define SKETCH_MASK         (SKETCH_WIDTH - 1)
+#define SKETCH_STRIPE_CELLS (SKETCH_ROWS * SKETCH_WIDTH)
+#define SKETCH_ROW_SEED     (0x9e3779b97f4a7c15ull)
+
+_Static_assert((SKETCH_WIDTH & SKETCH_MASK) == 0, "sketch width must be a power of two");
+_Static_assert(sizeof(sketch_cell_t) == 16, "four cells per cache line");
+
+/* Updates per stripe, each on its own line like the stripe it counts */
+typedef struct {
+    _Atomic uint64_t count;
+} __attribute__((aligned(64))) sketch_updates_t;
+
+static _Atomic(sketch_cell_t *)   _cells;          /* owned, nil until the first observation */
+static sketch_updates_t           _updates[SKETCH_STRIPES];
+static pthread_once_t             _once = PTHREAD_ONCE_INIT;
+static _Atomic uint32_t           _next_stripe;
+static _Thread_local int32_t      _stripe = -1;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void             sketch_allocate_(void);
+static copied uint32_t  sketch_stripe_(void);
+static copied uint32_t  sketch_key_(borrowed const sketch_context_t * context, copied uint32_t order);
+static copied uint32_t  sketch_hash_(copied uint32_t key, copied uint32_t row);
+static void             sketch_decay_(borrowed sketch_cell_t * cells);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Public API
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void sketch_context_init(borrowed sketch_context_t * context)
+{
+    memset(context, 0, sizeof(*context));
+}
+
+copied bool sketch_observe(borrowed sketch_context_t * context, copied move_t next)
+{
+    pthread_once(&_once, sketch_allocate_);
+    borrowed sketch_cell_t * all = atomic_load_explicit(&_cells, memory_order_relaxed);
+    if (all)
+    {
+        copied uint32_t         stripe = sketch_stripe_();
+        borrowed sketch_cell_t * cells = all + cast(stripe, size_t) * SKETCH_STRIPE_CELLS;
+        for (uint32_t order = 0; order <= context->count; order++)
+        {
+            copied uint32_t key = sketch_key_(context, order);
+            for (uint32_t row = 0; row < SKETCH_ROWS; row++)
+            {
+                borrowed sketch_cell_t * cell = &cells[row * SKETCH_WIDTH + sketch_hash_(key, row)];
+                atomic_fetch_add_explicit(&cell->counts[next], 1, memory_order_relaxed);
+            }
+        }
+
+        copied uint64_t updates = atomic_fetch_add_explicit(&_updates[stripe].count, 1, memory_order_relaxed) + 1;
+        if (updates % SKETCH_DECAY_PERIOD == 0)
+        {
+            sketch_decay_(cells);
+        }
+    }
+
+    sketch_context_push(context, next);
+    return all != nil;
+}
+
+void sketch_context_push(borrowed sketch_context_t * context, copied move_t next)
+{
+    if (context->count == SKETCH_ORDER)
+    {
+        memmove(context->moves, context->moves + 1, SKETCH_ORDER - 1);
+        context->count--;
+    }
+    context->moves[context->count++] = cast(next, uint8_t);
+}
+
+copied int32_t sketch_predict(borrowed const sketch_context_t * context, copied uint32_t confident, borrowed uint64_t * counts)
+{
+    /* reading never allocates: nothing observed yet is nothing to predict from */
+    borrowed const sketch_cell_t * all = atomic_load_explicit(&_cells, memory_order_acquire);
+    if (!all)
+    {
+        return -1;
+    }
+
+    for (int32_t order = cast(context->count, int32_t); order >= 0; order--)
+    {
+        copied uint32_t key   = sketch_key_(context, cast(order, uint32_t));
+        copied uint64_t total = 0;
+        for (uint32_t m = 0; m < moves_count; m++)
+        {
+            /* the stripes add up to one sketch: sum them per row, then take the row minimum */
+            copied uint64_t least = UINT64_MAX;
+            for (uint32_t row = 0; row < SKETCH_ROWS; row++)
+            {
+                copied uint32_t cell = row * SKETCH_WIDTH + sketch_hash_(key, row);
+                copied uint64_t sum  = 0;
+                for (uint32_t s = 0; s < SKETCH_STRIPES; s++)
+                {
+                    sum += atomic_load_explicit(&all[cast(s, size_t) * SKETCH_STRIPE_CELLS + cell].counts[m], memory_order_relaxed);
+                }
+                least = (sum < least) ? sum : least;
+            }
+            counts[m] = least;
+            total    += least;
+        }
+        if (total >= confident)
+        {
+            return order;
+        }
+    }
+    return -1;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void sketch_allocate_(void)
+{
+    owned sketch_cell_t * cells = aligned_alloc(64, SKETCH_BYTES);
+    if (cells)
+    {
+        memset(cells, 0, SKETCH_BYTES);
+        atomic_store_explicit(&_cells, cells, memory_order_release);
+    }
+}
+
+/* Threads take the stripes in turn, so up to SKETCH_STRIPES of them never share a line. */
+static copied uint32_t sketch_stripe_(void)
+{
+    if (_stripe < 0)
+    {
+        _stripe = cast(atomic_fetch_add_explicit(&_next_stripe, 1, memory_order_relaxed) % SKETCH_STRIPES, int32_t);
+    }
+    return cast(_stripe, uint32_t);
+}
+
+/*
+ * The last `order` moves in base 3, tagged with the order so that runs of different lengths
+ * never collide. Order 0 is the empty run: its cells count every move of every player.
+ */
+static copied uint32_t sketch_key_(borrowed const sketch_context_t * context, copied uint32_t order)
+{
+    copied uint32_t key = 0;
+    for (uint32_t i = context->count - order; i < context->count; i++)
+    {
+        key = key * moves_count + context->moves[i];
+    }
+    return (order << 8) | key;
+}
+
+/* splitmix64's finaliser, seeded apart per row */
+static copied uint32_t sketch_hash_(copied uint32_t key, copied uint32_t row)
+{
+    copied uint64_t x = key + (row + 1) * SKETCH_ROW_SEED;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    x =  x ^ (x >> 31);
+    return cast(x & SKETCH_MASK, uint32_t);
+}
+
+/*
+ * Halves one stripe. Other threads of the stripe may add meanwhile and lose an increment
+ * to a halving, which a sketch shrugs off; no one ever waits.
+ */
+static void sketch_decay_(borrowed sketch_cell_t * cells)
+{
+    for (uint32_t c = 0; c < SKETCH_STRIPE_CELLS; c++)
+    {
+        for (uint32_t m = 0; m < moves_count; m++)
+        {
+            copied uint32_t v = atomic_load_explicit(&cells[c].counts[m], memory_order_relaxed);
+            atomic_store_explicit(&cells[c].counts[m], v >> 1, memory_order_relaxed);
+        }
+    }
+}
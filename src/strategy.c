@@ -0,0 +1,363 @@
+#include "strategy.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "meta.h"
+#include "rng.h"
+#include "bandit.h"
+#include "table.h"
+#include "tuning.h"
+#include "sketch.h"
+
+/* Arms of the adaptive strategy, from easiest to hardest to beat */
+typedef enum {
+    adaptive_yield,     /* plays what loses to the predicted move */
+    adaptive_fair,      /* uniform random */
+    adaptive_exploit,   /* plays what beats the predicted move, like "meta" */
+} adaptive_arm_t;
+
+_Static_assert(BANDIT_ARMS == 3, "one bandit arm per adaptive_arm_t");
+
+/* One meta model shared by all arms: the bandit only decides how to use its prediction */
+typedef struct {
+    copied bandit_t bandit;
+    copied rng_t    rng;
+    copied meta_t   meta;
+    copied f32      target;         /* the match's own, unless the tuning overrides it */
+    copied uint64_t generation;     /* of the tuning the bandit was last tuned with */
+} adaptive_t;
+
+/* The population strategy: what most players did after the same moves, see sketch.h */
+/* It only reads the sketch; the loop playing the rounds fills it, as it fills the history */
+#define POPULATION_CONFIDENT    (16)    /* sketched rounds a context needs before it is trusted */
+
+typedef struct {
+    copied sketch_context_t context;
+    copied rng_t            rng;
+} population_t;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void strategy_random_choose_n_(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out);
+static void strategy_meta_choose_n_(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out);
+static void strategy_meta_observe_(borrowed void * state, copied move_t player, copied move_t computer);
+static void strategy_adaptive_choose_n_(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out);
+static void strategy_adaptive_observe_(borrowed void * state, copied move_t player, copied move_t computer);
+static void strategy_population_choose_n_(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out);
+static void strategy_population_observe_(borrowed void * state, copied move_t player, copied move_t computer);
+static void strategy_table_choose_n_(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out);
+static void strategy_table_observe_(borrowed void * state, copied move_t player, copied move_t computer);
+static void strategy_bot_choose_n_(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Lifecycle
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool strategy_create(borrowed strategy_t * strategy, borrowed const char * name, copied uint64_t seed)
+{
+    memset(strategy, 0, sizeof(*strategy));
+
+    if (0 == strcmp(name, "random"))
+    {
+        owned rng_t * rng = malloc(sizeof(rng_t));
+        if (!rng)
+        {
+            return false;
+        }
+        rng_seed(rng, seed, RNG_STREAM_RANDOM);
+
+        strategy->name     = "random";
+        strategy->state    = rng;
+        strategy->batch    = UINT32_MAX;
+        strategy->choose_n = strategy_random_choose_n_;
+        strategy->destroy  = free;
+        return true;
+    }
+
+    if (0 == strcmp(name, "meta"))
+    {
+        owned meta_t * meta = malloc(sizeof(meta_t));
+        if (!meta)
+        {
+            return false;
+        }
+        meta_init(meta, seed);
+
+        strategy->name     = "meta";
+        strategy->state    = meta;
+        strategy->batch    = 1;
+        strategy->choose_n = strategy_meta_choose_n_;
+        strategy->observe  = strategy_meta_observe_;
+        strategy->destroy  = free;
+        return true;
+    }
+
+    if (0 == strcmp(name, "adaptive"))
+    {
+        return strategy_create_adaptive(strategy, seed, BANDIT_TARGET);
+    }
+
+    if (0 == strcmp(name, "population"))
+    {
+        owned population_t * population = malloc(sizeof(population_t));
+        if (!population)
+        {
+            return false;
+        }
+        sketch_context_init(&population->context);
+        rng_seed(&population->rng, seed, RNG_STREAM_POPULATION);
+
+        strategy->name         = "population";
+        strategy->state        = population;
+        strategy->batch        = 1;
+        strategy->reads_sketch = true;
+        strategy->choose_n     = strategy_population_choose_n_;
+        strategy->observe      = strategy_population_observe_;
+        strategy->destroy      = free;
+        return true;
+    }
+
+    return false;
+}
+
+copied bool strategy_create_adaptive(borrowed strategy_t * strategy, copied uint64_t seed, copied f32 target)
+{
+    memset(strategy, 0, sizeof(*strategy));
+
+    owned adaptive_t * adaptive = aligned_alloc(_Alignof(adaptive_t), sizeof(adaptive_t));
+    if (!adaptive)
+    {
+        return false;
+    }
+    bandit_init(&adaptive->bandit, target);
+    rng_seed(&adaptive->rng, seed, RNG_STREAM_BANDIT);
+    meta_init(&adaptive->meta, seed);
+    adaptive->target     = target;
+    adaptive->generation = 0;       /* bandit_init() starts from the default tuning */
+
+    strategy->name     = "adaptive";
+    strategy->state    = adaptive;
+    strategy->batch    = 1;
+    strategy->choose_n = strategy_adaptive_choose_n_;
+    strategy->observe  = strategy_adaptive_observe_;
+    strategy->destroy  = free;
+    return true;
+}
+
+copied bool strategy_create_table(borrowed strategy_t * strategy, borrowed const uint8_t * moves)
+{
+    memset(strategy, 0, sizeof(*strategy));
+
+    owned table_t * table = malloc(sizeof(table_t));
+    if (!table)
+    {
+        return false;
+    }
+    table_init(table, moves);
+
+    strategy->name     = "table";
+    strategy->state    = table;
+    strategy->batch    = 1;
+    strategy->choose_n = strategy_table_choose_n_;
+    strategy->observe  = strategy_table_observe_;
+    strategy->destroy  = free;
+    return true;
+}
+
+void strategy_from_bot(borrowed strategy_t * strategy, borrowed bot_t * bot)
+{
+    memset(strategy, 0, sizeof(*strategy));
+    strategy->name     = bot->api->name ? bot->api->name : "bot";
+    strategy->state    = bot;
+    strategy->batch    = UINT32_MAX;
+    strategy->choose_n = strategy_bot_choose_n_;
+}
+
+copied bool strategy_load(borrowed strategy_t * strategy, borrowed bot_t * bot, borrowed const strategy_spec_t * spec, borrowed const char ** error)
+{
+    if (spec->bot_path)
+    {
+        if (!bot_load(bot, spec->bot_path, spec->seed, error))
+        {
+            return false;
+        }
+        strategy_from_bot(strategy, bot);
+        return true;
+    }
+
+    if (spec->table_path)
+    {
+        copied uint8_t moves[TABLE_SIZE];
+        if (!table_load(spec->table_path, moves, error))
+        {
+            return false;
+        }
+        if (!strategy_create_table(strategy, moves))
+        {
+            *error = "out of memory";
+            return false;
+        }
+        return true;
+    }
+
+    copied bool created = (0 == strcmp(spec->name, "adaptive"))
+                        ? strategy_create_adaptive(strategy, spec->seed, spec->target_win_rate)
+                        : strategy_create(strategy, spec->name, spec->seed);
+    if (!created)
+    {
+        *error = "unknown opponent (expected one of: " STRATEGY_NAMES ")";
+        return false;
+    }
+    return true;
+}
+
+void strategy_destroy(borrowed strategy_t * strategy)
+{
+    if (strategy->destroy)
+    {
+        strategy->destroy(strategy->state);
+    }
+    memset(strategy, 0, sizeof(*strategy));
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Dispatch
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied move_t strategy_choose(borrowed strategy_t * strategy, borrowed const history_t * history)
+{
+    copied uint8_t move = 0;
+    strategy->choose_n(strategy->state, history, 1, &move);
+    return cast(move, move_t);
+}
+
+void strategy_choose_n(borrowed strategy_t * strategy, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out)
+{
+    strategy->choose_n(strategy->state, history, n, out);
+}
+
+void strategy_observe(borrowed strategy_t * strategy, copied move_t player, copied move_t computer)
+{
+    if (strategy->observe)
+    {
+        strategy->observe(strategy->state, player, computer);
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Built-in Strategies
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void strategy_random_choose_n_(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out)
+{
+    (void) history;
+    rng_moves(state, out, n);
+}
+
+static void strategy_meta_choose_n_(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out)
+{
+    (void) history;
+    copied move_t move = meta_choose(state);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        out[i] = cast(move, uint8_t);
+    }
+}
+
+static void strategy_meta_observe_(borrowed void * state, copied move_t player, copied move_t computer)
+{
+    meta_observe(state, player, computer);
+}
+
+static void strategy_adaptive_choose_n_(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out)
+{
+    (void) history;
+    borrowed adaptive_t * adaptive = state;
+
+    /* a reloaded tuning takes effect from the next round on */
+    borrowed const tuning_t * tuning = tuning_lock();
+    if (tuning->generation != adaptive->generation)
+    {
+        copied f32 target = tuning->target_win_rate > 0.0f ? tuning->target_win_rate : adaptive->target;
+        bandit_tune(&adaptive->bandit, target, tuning->exploration, tuning->decay);
+        adaptive->generation = tuning->generation;
+    }
+    tuning_unlock();
+
+    /* meta plays the move that beats its prediction p, i.e. p + 1; p - 1 = p + 2 loses to p */
+    copied move_t move = meta_choose(&adaptive->meta);
+    switch (cast(bandit_pick(&adaptive->bandit, &adaptive->rng), adaptive_arm_t))
+    {
+        case adaptive_yield:    move = cast((move + 1) % moves_count, move_t);                  break;
+        case adaptive_fair:     move = cast(rng_below(&adaptive->rng, moves_count), move_t);    break;
+        case adaptive_exploit:                                                                  break;
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        out[i] = cast(move, uint8_t);
+    }
+}
+
+static void strategy_adaptive_observe_(borrowed void * state, copied move_t player, copied move_t computer)
+{
+    borrowed adaptive_t * adaptive = state;
+
+    copied const f32 scores[3] = { [result_draw] = 0.5f, [result_win] = 1.0f, [result_lose] = 0.0f };
+    bandit_update(&adaptive->bandit, scores[judge(player, computer)]);
+    meta_observe(&adaptive->meta, player, computer);
+}
+
+/* Plays what beats the population's most likely next move, at random until it has one. */
+static void strategy_population_choose_n_(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out)
+{
+    (void) history;
+    borrowed population_t * population = state;
+
+    copied uint64_t counts[3];
+    copied move_t   move = cast(rng_below(&population->rng, moves_count), move_t);
+    if (sketch_predict(&population->context, POPULATION_CONFIDENT, counts) >= 0)
+    {
+        copied uint32_t likely = 0;
+        for (uint32_t m = 1; m < moves_count; m++)
+        {
+            likely = (counts[m] > counts[likely]) ? m : likely;
+        }
+        move = cast((likely + 1) % moves_count, move_t);
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        out[i] = cast(move, uint8_t);
+    }
+}
+
+static void strategy_population_observe_(borrowed void * state, copied move_t player, copied move_t computer)
+{
+    (void) computer;
+    borrowed population_t * population = state;
+    sketch_context_push(&population->context, player);
+}
+
+static void strategy_table_choose_n_(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out)
+{
+    (void) history;
+    copied move_t move = table_choose(state);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        out[i] = cast(move, uint8_t);
+    }
+}
+
+static void strategy_table_observe_(borrowed void * state, copied move_t player, copied move_t computer)
+{
+    table_observe(state, player, computer);
+}
+
+static void strategy_bot_choose_n_(borrowed void * state, borrowed const history_t * history, copied uint32_t n, borrowed uint8_t * out)
+{
+    bot_choose_n(state, history, n, out);
+}
@@ -0,0 +1,145 @@
+#include "table.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#define TABLE_LINE_MAX      (256)
+#define TABLE_FORMAT_ERROR  "expected 81 digits 0-2"
+
+static borrowed const char * const _reference_names[TABLE_REFERENCES] = {
+    [reference_rock]          = "rock",
+    [reference_cycle]         = "cycle",
+    [reference_reverse_cycle] = "reverse-cycle",
+    [reference_repeat]        = "repeat",
+    [reference_copy]          = "copy",
+    [reference_beat_last]     = "beat-last",
+    [reference_win_stay]      = "win-stay",
+    [reference_lose_stay]     = "lose-stay",
+};
+
+_Static_assert(reference_lose_stay + 1 == TABLE_REFERENCES, "one name per reference_t");
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Strategy
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void table_init(borrowed table_t * table, borrowed const uint8_t * moves)
+{
+    memcpy(table->moves, moves, TABLE_SIZE);
+    table->context = 0;
+}
+
+copied move_t table_choose(borrowed const table_t * table)
+{
+    return cast(table->moves[table->context], move_t);
+}
+
+void table_observe(borrowed table_t * table, copied move_t player, copied move_t computer)
+{
+    table->context = TABLE_NEXT(table->context, player, computer);
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Reference Players
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void table_reference(copied reference_t reference, borrowed uint8_t * moves)
+{
+    for (uint32_t context = 0; context < TABLE_SIZE; context++)
+    {
+        /* the newest round is the lowest base-9 digit */
+        copied uint8_t player   = cast((context % TABLE_SYMBOLS) / 3, uint8_t);
+        copied uint8_t computer = cast(context % 3, uint8_t);
+        copied bool    won      = judge(player, computer) == result_win;
+
+        copied uint8_t choices[TABLE_REFERENCES] = {
+            [reference_rock]          = move_rock,
+            [reference_cycle]         = cast((player + 1) % 3, uint8_t),
+            [reference_reverse_cycle] = cast((player + 2) % 3, uint8_t),
+            [reference_repeat]        = player,
+            [reference_copy]          = computer,
+            [reference_beat_last]     = cast((computer + 1) % 3, uint8_t),
+            [reference_win_stay]      = won ? player : cast((player + 1) % 3, uint8_t),
+            [reference_lose_stay]     = won ? cast((player + 1) % 3, uint8_t) : player,
+        };
+        moves[context] = choices[reference];
+    }
+}
+
+copied bool table_reference_parse(borrowed const char * name, borrowed reference_t * reference)
+{
+    for (uint32_t r = 0; r < TABLE_REFERENCES; r++)
+    {
+        if (0 == strcmp(name, _reference_names[r]))
+        {
+            *reference = cast(r, reference_t);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Files
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool table_load(borrowed const char * path, borrowed uint8_t * moves, borrowed const char ** error)
+{
+    borrowed FILE * file = fopen(path, "r");
+    if (!file)
+    {
+        *error = strerror(errno);
+        return false;
+    }
+
+    copied char   line[TABLE_LINE_MAX];
+    copied size_t count = 0;
+    *error = nil;
+    while (!*error && fgets(line, sizeof(line), file))
+    {
+        if (line[0] == '#')
+        {
+            continue;
+        }
+        for (char * c = line; *c && !*error; c++)
+        {
+            if ('0' <= *c && *c <= '2' && count < TABLE_SIZE)
+            {
+                moves[count++] = cast(*c - '0', uint8_t);
+            }
+            else if (*c != ' ' && *c != '\t' && *c != '\n' && *c != '\r')
+            {
+                *error = TABLE_FORMAT_ERROR;
+            }
+        }
+    }
+    fclose(file);
+
+    if (!*error && count != TABLE_SIZE)
+    {
+        *error = TABLE_FORMAT_ERROR;
+    }
+    return !*error;
+}
+
+copied bool table_save(borrowed const char * path, borrowed const uint8_t * moves, borrowed const char * comment)
+{
+    borrowed FILE * file = fopen(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+
+    if (comment)
+    {
+        fprintf(file, "# %s\n", comment);
+    }
+    for (size_t i = 0; i < TABLE_SIZE; i++)
+    {
+        fputc('0' + moves[i], file);
+    }
+    fputc('\n', file);
+
+    return 0 == fclose(file);
+}
@@ -3,12 +3,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <termios.h>
 #include <signal.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 
+#include "metrics.h"
+
 /* ─────────────────────────────────────────────────────────────────────────────
  * ANSI Escape Sequences
  * ───────────────────────────────────────────────────────────────────────────── */
@@ -18,18 +22,17 @@
 
 #define CURSOR_HIDE         (CSI "?25l")        // hide cursor
 #define CURSOR_SHOW         (CSI "?25h")        // show cursor
+#define SCREEN_ENTER        (CSI "?1049h" CSI "?7l" CSI "2J")   // alternate screen, no autowrap, cleared
+#define SCREEN_LEAVE        (CSI "?7h" CSI "?1049l")            // autowrap back on, main screen
+
+#define TERMINAL_IOV_MAX    (64)                /* max segments per terminal_writev() */
 
 /* ─────────────────────────────────────────────────────────────────────────────
  * Module State
  * ───────────────────────────────────────────────────────────────────────────── */
 
-static struct {
-    copied struct termios original;         /* Original terminal attributes */
-    copied bool           raw;              /* True if raw mode is active */
-} _terminal_state = {
-    .original = { 0 },
-    .raw      = false,
-};
+/* The terminal to restore on SIGINT / SIGTERM / exit: the one raw on a real tty */
+static terminal_t * volatile _terminal_restore = nil;
 
 /* ─────────────────────────────────────────────────────────────────────────────
  * Forward Declarations
@@ -37,31 +40,78 @@ static struct {
 
 static void terminal_setup_raw_mode_signals_();
 static void terminal_sig_default_handler_(copied int sig);
+static void terminal_restore_at_exit_();
+static void terminal_send_(borrowed terminal_t * term, borrowed struct iovec * iov, copied int count);
+static copied int terminal_wait_(borrowed terminal_t * term, borrowed struct pollfd * fds, copied int count, copied int timeout_ms);
 
 /* ─────────────────────────────────────────────────────────────────────────────
  * Raw Mode
  * ───────────────────────────────────────────────────────────────────────────── */
 
-void terminal_enter_raw_mode()
+void terminal_init(borrowed terminal_t * term, copied int in, copied int out)
+{
+    memset(term, 0, sizeof(*term));
+    term->in  = in;
+    term->out = out;
+}
+
+void terminal_fin(borrowed terminal_t * term)
+{
+    terminal_flush(term);
+    free(term->buffer);
+    term->buffer   = nil;
+    term->used     = 0;
+    term->capacity = 0;
+}
+
+void terminal_tap(borrowed terminal_t * term, borrowed terminal_tap_fn * tap, borrowed void * context)
+{
+    term->tap         = tap;
+    term->tap_context = context;
+}
+
+void terminal_wait(borrowed terminal_t * term, borrowed terminal_wait_fn * wait, borrowed void * context)
+{
+    term->wait         = wait;
+    term->wait_context = context;
+    term->wait_first   = wait && !(fcntl(term->in, F_GETFL) & O_NONBLOCK);
+}
+
+copied bool terminal_buffer(borrowed terminal_t * term, copied size_t capacity)
 {
-    if (_terminal_state.raw)
+    terminal_flush(term);
+    owned char * buffer = realloc(term->buffer, capacity);
+    if (!buffer)
     {
-        return;
+        return false;
+    }
+    term->buffer   = buffer;
+    term->capacity = capacity;
+    return true;
+}
+
+copied bool terminal_enter_raw_mode(borrowed terminal_t * term)
+{
+    if (term->raw)
+    {
+        return true;
     }
 
-    /* STDIN must be a terminal */
-    if (0 == isatty(STDIN_FILENO))
+    /* not a terminal: nothing to configure, the peer sends raw bytes anyway */
+    if (0 == isatty(term->in))
     {
-        exit(EXIT_FAILURE);
+        term->raw = true;
+        terminal_cursor_hide(term);
+        return true;
     }
 
     /* save original terminal attributes */
-    if (-1 == tcgetattr(STDIN_FILENO, &_terminal_state.original))
+    if (-1 == tcgetattr(term->in, &term->original))
     {
-        exit(EXIT_FAILURE);
+        return false;
     }
 
-    copied struct termios term = clone(_terminal_state.original);
+    copied struct termios raw = clone(term->original);
 
     /*
      * Input flags:
@@ -71,19 +121,19 @@ void terminal_enter_raw_mode()
      * - INPCK: Disable parity checking
      * - ISTRIP: Disable stripping of 8th bit
      */
-    term.c_iflag &= ~(IXON | ICRNL | BRKINT | INPCK | ISTRIP);
+    raw.c_iflag &= ~(IXON | ICRNL | BRKINT | INPCK | ISTRIP);
 
     /*
      * Output flags:
      * - OPOST: Disable output processing
      */
-    term.c_oflag &= ~(OPOST);
+    raw.c_oflag &= ~(OPOST);
 
     /*
      * Control flags:
      * - CS8: Set character size to 8 bits
      */
-    term.c_cflag |= (CS8);
+    raw.c_cflag |= (CS8);
 
     /*
      * Local flags:
@@ -92,53 +142,89 @@ void terminal_enter_raw_mode()
      * - ISIG: Disable Ctrl-C/Ctrl-Z signals
      * - IEXTEN: Disable Ctrl-V
      */
-    term.c_lflag &= ~(ECHO | ICANON | ISIG | IEXTEN);
+    raw.c_lflag &= ~(ECHO | ICANON | ISIG | IEXTEN);
 
     /*
      * Control characters:
      * - VMIN: Minimum bytes for read (1 = blocking read)
      * - VTIME: Timeout (0 = no timeout)
      */
-    term.c_cc[VMIN]  = 1;
-    term.c_cc[VTIME] = 0;
+    raw.c_cc[VMIN]  = 1;
+    raw.c_cc[VTIME] = 0;
 
-    tcsetattr(STDIN_FILENO, TCSAFLUSH, &term);
+    tcsetattr(term->in, TCSAFLUSH, &raw);
 
-    terminal_cursor_hide();
+    terminal_cursor_hide(term);
 
-    terminal_setup_raw_mode_signals_();
-
-    atexit(terminal_leave_raw_mode);
+    if (!_terminal_restore)
+    {
+        terminal_setup_raw_mode_signals_();
+        atexit(terminal_restore_at_exit_);
+    }
+    _terminal_restore = term;
 
-    _terminal_state.raw = true;
+    term->raw = true;
+    return true;
 }
 
-void terminal_leave_raw_mode()
+void terminal_leave_raw_mode(borrowed terminal_t * term)
 {
-    if (!_terminal_state.raw)
+    if (!term->raw)
     {
         return;
     }
 
-    tcsetattr(STDIN_FILENO, TCSAFLUSH, &_terminal_state.original);
+    if (isatty(term->in))
+    {
+        tcsetattr(term->in, TCSAFLUSH, &term->original);
+    }
 
-    terminal_cursor_show();
+    terminal_screen_leave(term);
+    terminal_cursor_show(term);
 
-    _terminal_state.raw = false;
+    term->raw = false;
+    if (_terminal_restore == term)
+    {
+        _terminal_restore = nil;
+    }
 }
 
-void terminal_toggle_raw_mode()
+void terminal_toggle_raw_mode(borrowed terminal_t * term)
 {
-    if (_terminal_state.raw)
+    if (term->raw)
     {
-        terminal_leave_raw_mode();
+        terminal_leave_raw_mode(term);
     }
     else
     {
-        terminal_enter_raw_mode();
+        terminal_enter_raw_mode(term);
     }
 }
 
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Alternate Screen
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+void terminal_screen_enter(borrowed terminal_t * term)
+{
+    if (term->screen)
+    {
+        return;
+    }
+    terminal_write(term, SCREEN_ENTER, sizeof(SCREEN_ENTER) - 1);
+    term->screen = true;
+}
+
+void terminal_screen_leave(borrowed terminal_t * term)
+{
+    if (!term->screen)
+    {
+        return;
+    }
+    terminal_write(term, SCREEN_LEAVE, sizeof(SCREEN_LEAVE) - 1);
+    term->screen = false;
+}
+
 /* ─────────────────────────────────────────────────────────────────────────────
  * Signal Handling
  * ───────────────────────────────────────────────────────────────────────────── */
@@ -155,61 +241,244 @@ static void terminal_setup_raw_mode_signals_()
     sigaction(SIGTERM, &sa, nil);
 }
 
+/*
+ * Only async-signal-safe calls here: the tap, the output buffer and the metrics may be
+ * halfway through an update, so the sequences go straight to the descriptor with write().
+ */
 static void terminal_sig_default_handler_(copied int sig)
 {
-    (void) sig;
-    terminal_leave_raw_mode();
+    borrowed terminal_t * term = _terminal_restore;
+    if (term)
+    {
+        tcsetattr(term->in, TCSAFLUSH, &term->original);
+
+        copied ssize_t n = 0;
+        if (term->screen)
+        {
+            n = write(term->out, SCREEN_LEAVE, sizeof(SCREEN_LEAVE) - 1);
+        }
+        n = write(term->out, CURSOR_SHOW, sizeof(CURSOR_SHOW) - 1);
+        (void) n;
+    }
     _exit(128 + sig);
 }
 
+static void terminal_restore_at_exit_()
+{
+    borrowed terminal_t * term = _terminal_restore;
+    if (term)
+    {
+        terminal_leave_raw_mode(term);
+    }
+}
+
 /* ─────────────────────────────────────────────────────────────────────────────
  * Terminal Screen (TUI) Operations
  * ───────────────────────────────────────────────────────────────────────────── */
-void terminal_writef(borrowed const char * fmt, ...)
+void terminal_write(borrowed terminal_t * term, borrowed const void * data, copied size_t len)
 {
-    if (!fmt)
+    copied struct iovec iov = { .iov_base = cast(data, void *), .iov_len = len };
+    terminal_writev(term, &iov, 1);
+}
+
+void terminal_writev(borrowed terminal_t * term, borrowed const struct iovec * iov, copied int count)
+{
+    copied struct iovec pending[TERMINAL_IOV_MAX];
+    if (count > TERMINAL_IOV_MAX)
+    {
+        count = TERMINAL_IOV_MAX;
+    }
+    memcpy(pending, iov, sizeof(struct iovec) * count);
+
+    /* the tap sees the output first, so it never waits for a slow terminal */
+    if (term->tap)
+    {
+        term->tap(term->tap_context, iov, count);
+    }
+
+    if (!term->buffer)
     {
+        terminal_send_(term, pending, count);
         return;
     }
-    va_list args;
-    va_start(args, fmt);
-    vfprintf(stdout, fmt, args);
-    fflush(stdout);
-    va_end(args);
+
+    copied size_t len = 0;
+    for (int i = 0; i < count; i++)
+    {
+        len += iov[i].iov_len;
+    }
+    if (len > term->capacity - term->used)
+    {
+        terminal_flush(term);
+    }
+    if (len > term->capacity)
+    {
+        terminal_send_(term, pending, count);
+        return;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        memcpy(term->buffer + term->used, iov[i].iov_base, iov[i].iov_len);
+        term->used += iov[i].iov_len;
+    }
 }
 
-void terminal_writef_owned(owned char * fmt, ...)
+void terminal_flush(borrowed terminal_t * term)
 {
-    if (!fmt)
+    if (term->used == 0)
     {
         return;
     }
-    va_list args;
-    va_start(args, fmt);
-    vfprintf(stdout, fmt, args);
-    fflush(stdout);
-    va_end(args);
-    free(fmt);
+    copied struct iovec iov = { .iov_base = term->buffer, .iov_len = term->used };
+    terminal_send_(term, &iov, 1);
+    term->used = 0;
+}
+
+copied int terminal_poll(borrowed terminal_t * term, borrowed struct pollfd * fds, copied int count, copied int timeout_ms)
+{
+    terminal_flush(term);
+    return terminal_wait_(term, fds, count, timeout_ms);
+}
+
+void terminal_cursor_hide(borrowed terminal_t * term)
+{
+    terminal_write(term, CURSOR_HIDE, sizeof(CURSOR_HIDE) - 1);
 }
 
-void terminal_cursor_hide()
+void terminal_cursor_show(borrowed terminal_t * term)
 {
-    terminal_write(CURSOR_HIDE, sizeof(CURSOR_HIDE) - 1);
+    terminal_write(term, CURSOR_SHOW, sizeof(CURSOR_SHOW) - 1);
 }
 
-void terminal_cursor_show()
+copied size_t terminal_cursor_column_sequence(borrowed char * buf, copied uint16_t col)
 {
-    terminal_write(CURSOR_SHOW, sizeof(CURSOR_SHOW) - 1);
+    /* CHA is 1-based, `col` is 0-based */
+    copied uint32_t n = cast(col, uint32_t) + 1;
+
+    copied char digits[5];
+    copied size_t count = 0;
+    do
+    {
+        digits[count++] = cast('0' + (n % 10), char);
+        n /= 10;
+    } while (n > 0);
+
+    copied size_t len = 0;
+    memcpy(buf, CSI, sizeof(CSI) - 1);
+    len += sizeof(CSI) - 1;
+    while (count > 0)
+    {
+        buf[len++] = digits[--count];
+    }
+    buf[len++] = 'G';
+    return len;
 }
 
-void terminal_flush()
+void terminal_cursor_column(borrowed terminal_t * term, copied uint16_t col)
 {
-    fflush(stdout);
+    copied char seq[16];
+    terminal_write(term, seq, terminal_cursor_column_sequence(seq, col));
 }
 
-copied int32_t terminal_raw_byte_read()
+copied int32_t terminal_raw_byte_read(borrowed terminal_t * term)
 {
+    terminal_flush(term);
+
+    /* a blocking input would never reach `wait`: go through it before reading */
+    if (term->wait_first)
+    {
+        copied struct pollfd pfd = { .fd = term->in, .events = POLLIN };
+        if (terminal_wait_(term, &pfd, 1, -1) < 0 && errno == EINTR)
+        {
+            return -1;
+        }
+    }
+
     copied unsigned char c;
-    return (1 == read(STDIN_FILENO, &c, 1)) ? c : -1;
+    for (;;)
+    {
+        copied ssize_t n = read(term->in, &c, 1);
+        if (n == 1)
+        {
+            return c;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            /* non-blocking input: wait for it, a signal still interrupts like a read */
+            copied struct pollfd pfd = { .fd = term->in, .events = POLLIN };
+            if (terminal_wait_(term, &pfd, 1, -1) < 0 && errno == EINTR)
+            {
+                return -1;
+            }
+            continue;
+        }
+        if (n == 0 || errno != EINTR)
+        {
+            term->closed = true;
+        }
+        return -1;
+    }
+}
+
+copied int32_t terminal_raw_byte_read_timeout(borrowed terminal_t * term, copied int timeout_ms)
+{
+    copied struct pollfd pfd = { .fd = term->in, .events = POLLIN };
+    if (terminal_poll(term, &pfd, 1, timeout_ms) <= 0)
+    {
+        return -1;
+    }
+    return terminal_raw_byte_read(term);
 }
 
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+/* Writes all of `iov` out, waiting for a non-blocking output to drain. Gives up on errors. */
+static void terminal_send_(borrowed terminal_t * term, borrowed struct iovec * iov, copied int count)
+{
+    borrowed struct iovec * cur = iov;
+    while (count > 0)
+    {
+        copied ssize_t n = writev(term->out, cur, count);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                copied struct pollfd pfd = { .fd = term->out, .events = POLLOUT };
+                terminal_wait_(term, &pfd, 1, -1);
+                continue;
+            }
+            return;
+        }
+
+        metrics_add(metric_terminal_writes, 1);
+        metrics_add(metric_terminal_bytes, n);
+
+        /* skip what was fully written, trim the partially written one */
+        while (count > 0 && cast(n, size_t) >= cur->iov_len)
+        {
+            n -= cur->iov_len;
+            cur++;
+            count--;
+        }
+        if (count > 0)
+        {
+            cur->iov_base = cast(cur->iov_base, char *) + n;
+            cur->iov_len -= n;
+        }
+    }
+}
+
+static copied int terminal_wait_(borrowed terminal_t * term, borrowed struct pollfd * fds, copied int count, copied int timeout_ms)
+{
+    if (term->wait)
+    {
+        return term->wait(term->wait_context, fds, count, timeout_ms);
+    }
+    return poll(fds, cast(count, nfds_t), timeout_ms);
+}
@@ -0,0 +1,364 @@
+#include "tuning.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include "bandit.h"
+
+#define TUNING_KEY_MAX      (32)
+#define TUNING_EVENTS       (4096)      /* bytes of inotify events read at once */
+
+/*
+ * A reader's slot: the epoch its current section entered in, 0 outside one. Slots are
+ * claimed once per thread, handed back when the thread exits, and never freed, so the
+ * writer can walk the list without any lock.
+ */
+typedef struct tuning_reader {
+    _Atomic  uint64_t               epoch;
+    _Atomic  bool                   used;
+    borrowed struct tuning_reader * next;
+} __attribute__((aligned(64))) tuning_reader_t;
+
+typedef struct {
+    owned char * directory;
+    owned char * name;
+    owned char * path;
+} tuning_watch_t;
+
+static const tuning_t                  _defaults = {
+    .target_win_rate = 0.0f,
+    .exploration     = BANDIT_EXPLORATION,
+    .decay           = BANDIT_DECAY,
+    .generation      = 0,
+};
+static _Atomic(const tuning_t *)        _current = &_defaults;
+static _Atomic uint64_t                 _epoch   = 1;
+static _Atomic(tuning_reader_t *)       _readers = nil;
+static _Thread_local tuning_reader_t  * _reader  = nil;
+static pthread_key_t                    _reader_key;
+static pthread_once_t                   _reader_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t                  _writer  = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t                         _generation;
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void           tuning_reader_key_(void);
+static void           tuning_reader_release_(borrowed void * slot);
+static void           tuning_reader_claim_(void);
+static void           tuning_publish_(owned tuning_t * tuning);
+static copied bool    tuning_reload_(borrowed const char * path);
+static void *         tuning_watch_main_(owned void * context);
+static copied bool    tuning_parse_line_(borrowed char * line, borrowed tuning_t * tuning, borrowed const char ** error);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Readers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+borrowed const tuning_t * tuning_lock(void)
+{
+    /* nothing was ever published: the defaults are never freed, so no slot is needed */
+    if (atomic_load_explicit(&_current, memory_order_acquire) == &_defaults)
+    {
+        return &_defaults;
+    }
+
+    if (!_reader)
+    {
+        tuning_reader_claim_();
+        if (!_reader)
+        {
+            /* out of memory: the defaults are never freed, so they need no slot */
+            return &_defaults;
+        }
+    }
+
+    /* announce the epoch first; a writer that misses it published before our load below */
+    atomic_store(&_reader->epoch, atomic_load(&_epoch));
+    return atomic_load(&_current);
+}
+
+void tuning_unlock(void)
+{
+    if (_reader)
+    {
+        atomic_store_explicit(&_reader->epoch, 0, memory_order_release);
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Files
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied bool tuning_load(borrowed const char * path, borrowed tuning_t * tuning, borrowed const char ** error)
+{
+    borrowed FILE * file = fopen(path, "r");
+    if (!file)
+    {
+        *error = strerror(errno);
+        return false;
+    }
+
+    *tuning = _defaults;
+    *error  = nil;
+    copied char line[TUNING_LINE_MAX];
+    while (!*error && fgets(line, sizeof(line), file))
+    {
+        tuning_parse_line_(line, tuning, error);
+    }
+    fclose(file);
+    return !*error;
+}
+
+copied bool tuning_watch(borrowed const char * path)
+{
+    if (!tuning_reload_(path))
+    {
+        return false;
+    }
+
+    /* editors often save by renaming over the file, so watch its directory for the name */
+    owned tuning_watch_t * watch = calloc(1, sizeof(*watch));
+    borrowed const char  * slash = strrchr(path, '/');
+    if (watch)
+    {
+        watch->path      = strdup(path);
+        watch->name      = strdup(slash ? slash + 1 : path);
+        watch->directory = slash ? strndup(path, cast(slash - path, size_t) + (slash == path)) : strdup(".");
+    }
+    if (!watch || !watch->path || !watch->name || !watch->directory)
+    {
+        fprintf(stderr, "rps: out of memory\n");
+        if (watch)
+        {
+            free(watch->path);
+            free(watch->name);
+            free(watch->directory);
+        }
+        free(watch);
+        return false;
+    }
+
+    copied pthread_t thread;
+    copied int       err = pthread_create(&thread, nil, tuning_watch_main_, watch);
+    if (err != 0)
+    {
+        fprintf(stderr, "rps: cannot watch '%s': %s\n", path, strerror(err));
+        free(watch->path);
+        free(watch->name);
+        free(watch->directory);
+        free(watch);
+        return false;
+    }
+    pthread_detach(thread);
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Helpers
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static void tuning_reader_key_(void)
+{
+    pthread_key_create(&_reader_key, tuning_reader_release_);
+}
+
+/* Runs at thread exit; the slot is quiet by then, so another thread may take it over. */
+static void tuning_reader_release_(borrowed void * slot)
+{
+    borrowed tuning_reader_t * reader = slot;
+    atomic_store(&reader->used, false);
+}
+
+static void tuning_reader_claim_(void)
+{
+    pthread_once(&_reader_once, tuning_reader_key_);
+
+    borrowed tuning_reader_t * reader = atomic_load(&_readers);
+    for (; reader; reader = reader->next)
+    {
+        copied bool free_slot = false;
+        if (atomic_compare_exchange_strong(&reader->used, &free_slot, true))
+        {
+            break;
+        }
+    }
+
+    if (!reader)
+    {
+        reader = aligned_alloc(_Alignof(tuning_reader_t), sizeof(tuning_reader_t));
+        if (!reader)
+        {
+            return;
+        }
+        atomic_init(&reader->epoch, 0);
+        atomic_init(&reader->used, true);
+        reader->next = atomic_load(&_readers);
+        while (!atomic_compare_exchange_weak(&_readers, &reader->next, reader))
+        {
+        }
+    }
+
+    pthread_setspecific(_reader_key, reader);
+    _reader = reader;
+}
+
+/*
+ * Swaps `tuning` in and frees the one it replaces after a grace period: once the epoch
+ * has moved on, a reader still showing an older one may hold the old tuning, any other
+ * cannot, so those are the only readers waited for.
+ */
+static void tuning_publish_(owned tuning_t * tuning)
+{
+    pthread_mutex_lock(&_writer);
+    tuning->generation = ++_generation;
+    borrowed const tuning_t * old = atomic_exchange(&_current, tuning);
+    copied   uint64_t         now = atomic_fetch_add(&_epoch, 1) + 1;
+
+    for (tuning_reader_t * reader = atomic_load(&_readers); reader; reader = reader->next)
+    {
+        copied uint64_t seen;
+        while ((seen = atomic_load(&reader->epoch)) != 0 && seen < now)
+        {
+            copied struct timespec pause = { .tv_sec = 0, .tv_nsec = TUNING_GRACE_NS };
+            nanosleep(&pause, nil);
+        }
+    }
+
+    if (old != &_defaults)
+    {
+        free(cast(old, void *));
+    }
+    pthread_mutex_unlock(&_writer);
+}
+
+static copied bool tuning_reload_(borrowed const char * path)
+{
+    owned tuning_t * tuning = malloc(sizeof(*tuning));
+    borrowed const char * error = "out of memory";
+    if (!tuning || !tuning_load(path, tuning, &error))
+    {
+        fprintf(stderr, "rps: %s: %s, keeping the tuning in force\n", path, error);
+        free(tuning);
+        return false;
+    }
+    tuning_publish_(tuning);
+    return true;
+}
+
+static void * tuning_watch_main_(owned void * context)
+{
+    owned tuning_watch_t * watch = context;
+    copied int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, watch->directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        fprintf(stderr, "rps: cannot watch '%s': %s\n", watch->path, strerror(errno));
+    }
+    else
+    {
+        copied char events[TUNING_EVENTS] __attribute__((aligned(_Alignof(struct inotify_event))));
+        for (;;)
+        {
+            copied ssize_t n = read(fd, events, sizeof(events));
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                break;
+            }
+
+            /* one reload per batch however many events name the file */
+            copied bool changed = false;
+            for (ssize_t at = 0; at < n; )
+            {
+                borrowed const struct inotify_event * event = cast(events + at, const struct inotify_event *);
+                changed |= event->len > 0 && 0 == strcmp(event->name, watch->name);
+                at += cast(sizeof(*event) + event->len, ssize_t);
+            }
+            if (changed)
+            {
+                tuning_reload_(watch->path);
+            }
+        }
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    free(watch->path);
+    free(watch->name);
+    free(watch->directory);
+    free(watch);
+    return nil;
+}
+
+/* One `key = value` line; blank lines and `#` comments are skipped. */
+static copied bool tuning_parse_line_(borrowed char * line, borrowed tuning_t * tuning, borrowed const char ** error)
+{
+    borrowed char * comment = strchr(line, '#');
+    if (comment)
+    {
+        *comment = '\0';
+    }
+
+    copied char key[TUNING_KEY_MAX];
+    copied char value[TUNING_KEY_MAX];
+    copied char rest;
+    copied int  fields = sscanf(line, " %31[a-z_] = %31s %c", key, value, &rest);
+    if (fields <= 0 && strspn(line, " \t\r\n") == strlen(line))
+    {
+        return true;
+    }
+    if (fields != 2)
+    {
+        *error = "expected key = value";
+        return false;
+    }
+
+    borrowed char * end = nil;
+    copied   f32    v   = strtof(value, &end);
+    if (*end != '\0')
+    {
+        *error = "expected a number";
+        return false;
+    }
+
+    copied bool valid = false;
+    if (0 == strcmp(key, "target_win_rate"))
+    {
+        tuning->target_win_rate = v;
+        valid = 0.0f < v && v < 1.0f;
+    }
+    else if (0 == strcmp(key, "exploration"))
+    {
+        tuning->exploration = v;
+        valid = 0.0f < v && v <= 1.0f;
+    }
+    else if (0 == strcmp(key, "decay"))
+    {
+        tuning->decay = v;
+        valid = 0.0f < v && v <= 1.0f;
+    }
+    else
+    {
+        *error = "unknown key (expected target_win_rate, exploration or decay)";
+        return false;
+    }
+
+    if (!valid)
+    {
+        *error = "value out of range";
+    }
+    return valid;
+}
@@ -0,0 +1,314 @@
+#include "unicode.h"
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Width Tables
+ *
+ * Sorted, non-overlapping ranges derived from Unicode EastAsianWidth.txt (W/F)
+ * and emoji-data.txt (Emoji_Presentation), trimmed to the blocks a terminal game
+ * can realistically print. Lookup is a binary search, so adding ranges is cheap.
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+typedef struct {
+    copied uint32_t first;
+    copied uint32_t last;
+} unicode_range_t;
+
+static const unicode_range_t _zero_width[] = {
+    { 0x0300,  0x036F  },   /* combining diacritical marks */
+    { 0x0483,  0x0489  },
+    { 0x0591,  0x05BD  },
+    { 0x0610,  0x061A  },
+    { 0x064B,  0x065F  },
+    { 0x200B,  0x200F  },   /* zero width space / joiners / marks */
+    { 0x2028,  0x202E  },
+    { 0x2060,  0x2064  },
+    { 0x20D0,  0x20FF  },   /* combining marks for symbols (keycap) */
+    { 0xFE00,  0xFE0F  },   /* variation selectors */
+    { 0xFE20,  0xFE2F  },
+    { 0xFEFF,  0xFEFF  },
+    { 0x1F3FB, 0x1F3FF },   /* emoji skin tone modifiers */
+    { 0xE0000, 0xE007F },   /* tags */
+    { 0xE0100, 0xE01EF },   /* variation selectors supplement */
+};
+
+static const unicode_range_t _wide[] = {
+    { 0x1100,  0x115F  },   /* hangul jamo */
+    { 0x231A,  0x231B  },
+    { 0x2329,  0x232A  },
+    { 0x23E9,  0x23EC  },
+    { 0x23F0,  0x23F0  },
+    { 0x23F3,  0x23F3  },
+    { 0x25FD,  0x25FE  },
+    { 0x2614,  0x2615  },
+    { 0x2648,  0x2653  },
+    { 0x267F,  0x267F  },
+    { 0x2693,  0x2693  },
+    { 0x26A1,  0x26A1  },
+    { 0x26AA,  0x26AB  },
+    { 0x26BD,  0x26BE  },
+    { 0x26C4,  0x26C5  },
+    { 0x26CE,  0x26CE  },
+    { 0x26D4,  0x26D4  },
+    { 0x26EA,  0x26EA  },
+    { 0x26F2,  0x26F3  },
+    { 0x26F5,  0x26F5  },
+    { 0x26FA,  0x26FA  },
+    { 0x26FD,  0x26FD  },
+    { 0x2705,  0x2705  },
+    { 0x270A,  0x270B  },   /* ✊ ✋ */
+    { 0x2728,  0x2728  },
+    { 0x274C,  0x274C  },
+    { 0x274E,  0x274E  },
+    { 0x2753,  0x2755  },
+    { 0x2757,  0x2757  },
+    { 0x2795,  0x2797  },
+    { 0x27B0,  0x27B0  },
+    { 0x27BF,  0x27BF  },
+    { 0x2B1B,  0x2B1C  },
+    { 0x2B50,  0x2B50  },
+    { 0x2B55,  0x2B55  },
+    { 0x2E80,  0x303E  },   /* CJK radicals .. CJK symbols */
+    { 0x3041,  0x33FF  },
+    { 0x3400,  0x4DBF  },
+    { 0x4E00,  0x9FFF  },
+    { 0xA000,  0xA4CF  },
+    { 0xA960,  0xA97F  },
+    { 0xAC00,  0xD7A3  },   /* hangul syllables */
+    { 0xF900,  0xFAFF  },
+    { 0xFE10,  0xFE19  },
+    { 0xFE30,  0xFE6F  },
+    { 0xFF00,  0xFF60  },   /* fullwidth forms */
+    { 0xFFE0,  0xFFE6  },
+    { 0x16FE0, 0x16FE4 },
+    { 0x17000, 0x18CFF },
+    { 0x1B000, 0x1B2FF },
+    { 0x1F004, 0x1F004 },
+    { 0x1F0CF, 0x1F0CF },
+    { 0x1F18E, 0x1F18E },
+    { 0x1F191, 0x1F19A },
+    { 0x1F200, 0x1F251 },
+    { 0x1F300, 0x1F320 },
+    { 0x1F32D, 0x1F335 },
+    { 0x1F337, 0x1F37C },
+    { 0x1F37E, 0x1F393 },
+    { 0x1F3A0, 0x1F3CA },
+    { 0x1F3CF, 0x1F3D3 },
+    { 0x1F3E0, 0x1F3F0 },
+    { 0x1F3F4, 0x1F3F4 },
+    { 0x1F3F8, 0x1F43E },
+    { 0x1F440, 0x1F440 },   /* 👀 */
+    { 0x1F442, 0x1F4FC },   /* 👊 📜 */
+    { 0x1F4FF, 0x1F53D },
+    { 0x1F54B, 0x1F54E },
+    { 0x1F550, 0x1F567 },
+    { 0x1F57A, 0x1F57A },
+    { 0x1F595, 0x1F596 },
+    { 0x1F5A4, 0x1F5A4 },
+    { 0x1F5FB, 0x1F64F },   /* 😵 */
+    { 0x1F680, 0x1F6C5 },
+    { 0x1F6CC, 0x1F6CC },
+    { 0x1F6D0, 0x1F6D2 },
+    { 0x1F6D5, 0x1F6D7 },
+    { 0x1F6DC, 0x1F6DF },
+    { 0x1F6EB, 0x1F6EC },
+    { 0x1F6F4, 0x1F6FC },
+    { 0x1F7E0, 0x1F7EB },
+    { 0x1F7F0, 0x1F7F0 },
+    { 0x1F90C, 0x1F93A },
+    { 0x1F93C, 0x1F945 },
+    { 0x1F947, 0x1F9FF },
+    { 0x1FA70, 0x1FAFF },   /* 🪨 🫱 */
+    { 0x20000, 0x2FFFD },
+    { 0x30000, 0x3FFFD },
+};
+
+#define ESC                 (0x1b)
+#define ZWJ                 (0x200D)
+#define VS16                (0xFE0F)
+#define REGIONAL_FIRST      (0x1F1E6)
+#define REGIONAL_LAST       (0x1F1FF)
+
+#define countof(a)          (sizeof(a) / sizeof((a)[0]))
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Forward Declarations
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+static copied bool unicode_in_table_(copied uint32_t cp, borrowed const unicode_range_t * table, copied size_t count);
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Decoding
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied uint32_t unicode_decode(borrowed const char * s, copied size_t len, borrowed size_t * consumed)
+{
+    borrowed const unsigned char * u = cast(s, const unsigned char *);
+
+    *consumed = (len > 0) ? 1 : 0;
+    if (len == 0)
+    {
+        return UNICODE_REPLACEMENT;
+    }
+
+    copied uint32_t cp;
+    copied size_t   need;
+    if (u[0] < 0x80)
+    {
+        return u[0];
+    }
+    else if ((u[0] & 0xE0) == 0xC0)
+    {
+        cp = u[0] & 0x1F; need = 2;
+    }
+    else if ((u[0] & 0xF0) == 0xE0)
+    {
+        cp = u[0] & 0x0F; need = 3;
+    }
+    else if ((u[0] & 0xF8) == 0xF0)
+    {
+        cp = u[0] & 0x07; need = 4;
+    }
+    else
+    {
+        return UNICODE_REPLACEMENT;
+    }
+
+    if (need > len)
+    {
+        return UNICODE_REPLACEMENT;
+    }
+
+    for (size_t i = 1; i < need; i++)
+    {
+        if ((u[i] & 0xC0) != 0x80)
+        {
+            return UNICODE_REPLACEMENT;
+        }
+        cp = (cp << 6) | (u[i] & 0x3F);
+    }
+
+    *consumed = need;
+    return cp;
+}
+
+/* ─────────────────────────────────────────────────────────────────────────────
+ * Width
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+copied uint8_t unicode_codepoint_width(copied uint32_t cp)
+{
+    if (cp < 0x20 || (0x7F <= cp && cp < 0xA0))
+    {
+        return 0;
+    }
+    if (cp < 0x0300)
+    {
+        return 1;
+    }
+    if (unicode_in_table_(cp, _zero_width, countof(_zero_width)))
+    {
+        return 0;
+    }
+    if (unicode_in_table_(cp, _wide, countof(_wide)))
+    {
+        return 2;
+    }
+    return 1;
+}
+
+copied uint16_t unicode_display_width(borrowed const char * s, copied size_t len)
+{
+    copied uint16_t columns   = 0;
+    copied uint8_t  last      = 0;      /* width of the current grapheme */
+    copied bool     joined    = false;  /* previous code point was a ZWJ */
+    copied bool     regional  = false;  /* an unpaired regional indicator is open */
+
+    for (size_t off = 0; off < len; )
+    {
+        /* SGR and other CSI sequences occupy no columns */
+        if (s[off] == ESC && off + 1 < len && s[off + 1] == '[')
+        {
+            off += 2;
+            while (off < len && !(0x40 <= s[off] && s[off] <= 0x7E))
+            {
+                off++;
+            }
+            off++;
+            continue;
+        }
+
+        copied size_t   n  = 0;
+        copied uint32_t cp = unicode_decode(s + off, len - off, &n);
+        off += n;
+
+        if (cp == ZWJ)
+        {
+            joined = true;
+            continue;
+        }
+
+        if (cp == VS16)
+        {
+            if (last == 1)
+            {
+                columns += 1;
+                last     = 2;
+            }
+            continue;
+        }
+
+        copied uint8_t w = unicode_codepoint_width(cp);
+        if (joined || w == 0)
+        {
+            joined = false;
+            continue;
+        }
+
+        if (REGIONAL_FIRST <= cp && cp <= REGIONAL_LAST)
+        {
+            regional = !regional;
+            if (!regional)
+            {
+                continue;   /* second half of a flag */
+            }
+            w = 2;
+        }
+        else
+        {
+            regional = false;
+        }
+
+        columns += w;
+        last     = w;
+    }
+
+    return columns;
+}
+
+static copied bool unicode_in_table_(copied uint32_t cp, borrowed const unicode_range_t * table, copied size_t count)
+{
+    if (cp < table[0].first || cp > table[count - 1].last)
+    {
+        return false;
+    }
+
+    copied size_t lo = 0;
+    copied size_t hi = count;
+    while (lo < hi)
+    {
+        copied size_t mid = lo + (hi - lo) / 2;
+        if (cp < table[mid].first)
+        {
+            hi = mid;
+        }
+        else if (cp > table[mid].last)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,124 @@
+/*
+ * markov_evaluate() against play: the exact rates of every reference player, with noise,
+ * against random tables must fall inside the confidence interval of a simulated match.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "game.h"
+#include "markov.h"
+#include "rng.h"
+#include "table.h"
+
+#define CHECK_ROUNDS    (2 * 1000 * 1000)
+#define CHECK_BATCHES   (100)           /* rounds are correlated: the error comes from batch means */
+#define CHECK_TABLES    (3)
+#define CHECK_NOISE     (0.2)
+#define CHECK_SIGMAS    (5.0)
+
+static copied move_t check_sample_(borrowed const f64 * moves, borrowed rng_t * rng)
+{
+    copied f64 u = cast(rng_next(rng), f64) * (1.0 / 4294967296.0);
+    if (u < moves[move_rock])
+    {
+        return move_rock;
+    }
+    return (u < moves[move_rock] + moves[move_paper]) ? move_paper : move_scissors;
+}
+
+/*
+ * Plays the two policies from context 0, as a table match starts, into the rate of each
+ * result and its standard error, estimated from the spread of CHECK_BATCHES batches.
+ */
+static void check_simulate_(borrowed const markov_policy_t * player, borrowed const markov_policy_t * computer, borrowed rng_t * rng, borrowed f64 * rates, borrowed f64 * errors)
+{
+    copied f64     sums[3]    = { 0 };
+    copied f64     squares[3] = { 0 };
+    copied uint8_t context    = 0;
+    for (uint32_t b = 0; b < CHECK_BATCHES; b++)
+    {
+        copied uint64_t tally[3] = { 0 };
+        for (uint32_t i = 0; i < CHECK_ROUNDS / CHECK_BATCHES; i++)
+        {
+            copied move_t p = check_sample_(player->moves[context], rng);
+            copied move_t c = check_sample_(computer->moves[context], rng);
+            tally[judge(p, c)]++;
+            context = TABLE_NEXT(context, p, c);
+        }
+        for (uint32_t r = 0; r < 3; r++)
+        {
+            copied f64 rate = cast(tally[r], f64) / (CHECK_ROUNDS / CHECK_BATCHES);
+            sums[r]    += rate;
+            squares[r] += rate * rate;
+        }
+    }
+    for (uint32_t r = 0; r < 3; r++)
+    {
+        rates[r]  = sums[r] / CHECK_BATCHES;
+        errors[r] = sqrt(fmax(squares[r] / CHECK_BATCHES - rates[r] * rates[r], 0.0) / (CHECK_BATCHES - 1));
+    }
+}
+
+int main(void)
+{
+    copied uint32_t failed = 0;
+    copied rng_t    rng;
+    rng_seed(&rng, 1, RNG_STREAM_PLAYER);
+
+    /* anything against uniform play is a third of each */
+    copied markov_policy_t player, computer;
+    copied markov_result_t result;
+    markov_policy_uniform(&player);
+    markov_policy_uniform(&computer);
+    if (!markov_evaluate(&player, &computer, &result) || fabs(result.rates[result_win] - 1.0 / 3.0) > 1e-9)
+    {
+        printf("uniform: win rate %.12f\n", result.rates[result_win]);
+        failed++;
+    }
+
+    /* rock forever against paper forever is lost every round */
+    copied uint8_t moves[TABLE_SIZE];
+    table_reference(reference_rock, moves);
+    markov_policy_table(&player, moves);
+    for (uint32_t c = 0; c < TABLE_SIZE; c++)
+    {
+        moves[c] = move_paper;
+    }
+    markov_policy_table(&computer, moves);
+    if (!markov_evaluate(&player, &computer, &result) || fabs(result.rates[result_lose] - 1.0) > 1e-9)
+    {
+        printf("rock against paper: loss rate %.12f\n", result.rates[result_lose]);
+        failed++;
+    }
+
+    for (uint32_t t = 0; t < CHECK_TABLES; t++)
+    {
+        rng_moves(&rng, moves, TABLE_SIZE);
+        markov_policy_table(&computer, moves);
+        for (uint32_t r = 0; r < TABLE_REFERENCES; r++)
+        {
+            copied uint8_t reference[TABLE_SIZE];
+            table_reference(cast(r, reference_t), reference);
+            markov_policy_table(&player, reference);
+            markov_policy_noise(&player, CHECK_NOISE);
+
+            copied f64  simulated[3], errors[3];
+            copied bool settled = markov_evaluate(&player, &computer, &result);
+            check_simulate_(&player, &computer, &rng, simulated, errors);
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                copied f64 margin = CHECK_SIGMAS * errors[k];
+                if (!settled || fabs(result.rates[k] - simulated[k]) > margin)
+                {
+                    printf("table %u, reference %u, result %u: exact %.6f, simulated %.6f ± %.6f%s\n",
+                           t, r, k, result.rates[k], simulated[k], margin, settled ? "" : " (not converged)");
+                    failed++;
+                }
+            }
+        }
+    }
+
+    printf("markov: %s\n", failed ? "FAIL" : "ok");
+    return failed ? 1 : 0;
+}
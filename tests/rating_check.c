@@ -0,0 +1,115 @@
+/*
+ * rating_top() and rating_percentile() against brute force: a sorted copy of every
+ * rating for the top K, a count of the lower buckets for the percentile.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rating.h"
+#include "rng.h"
+
+#define CHECK_PLAYERS       (200 * 1000)
+#define CHECK_GAMES         (20 * 1000)
+#define CHECK_PERCENTILES   (500)
+
+static int check_descending_(borrowed const void * a, borrowed const void * b)
+{
+    copied f32 x = *cast(a, const f32 *);
+    copied f32 y = *cast(b, const f32 *);
+    return (x < y) - (x > y);
+}
+
+static copied uint32_t check_bucket_(copied f32 rating)
+{
+    return (rating < 0.0f) ? 0 : (rating >= RATING_BUCKETS) ? RATING_BUCKETS - 1 : cast(rating, uint32_t);
+}
+
+int main(void)
+{
+    copied rng_t rng;
+    rng_seed(&rng, 1, RNG_STREAM_PLAYER);
+
+    /* ratings past both ends of the buckets, then games so the tree goes stale and is rebuilt */
+    copied rating_table_t table;
+    if (!rating_init(&table, 1024))
+    {
+        return 1;
+    }
+    for (uint32_t i = 0; i < CHECK_PLAYERS; i++)
+    {
+        copied f32 rating = cast(rng_below(&rng, RATING_BUCKETS + 800), f32) - 300.0f + cast(rng_below(&rng, 100), f32) / 100.0f;
+        rating_add(&table, 1000 + i, rating, 100.0f, 0);
+    }
+    owned rating_game_t * games = malloc(CHECK_GAMES * sizeof(rating_game_t));
+    owned f32           * sorted = malloc(CHECK_PLAYERS * sizeof(f32));
+    owned uint32_t      * slots  = malloc((CHECK_PLAYERS + 1) * sizeof(uint32_t));
+    if (!games || !sorted || !slots)
+    {
+        return 1;
+    }
+    for (uint32_t i = 0; i < CHECK_GAMES; i++)
+    {
+        games[i] = (rating_game_t) {
+            .player   = 1000 + rng_below(&rng, CHECK_PLAYERS),
+            .opponent = 1000 + rng_below(&rng, CHECK_PLAYERS),
+            .score    = cast(rng_below(&rng, 3), f32) / 2.0f,
+        };
+    }
+    rating_update_batch(&table, games, CHECK_GAMES);
+
+    for (uint32_t i = 0; i < CHECK_PLAYERS; i++)
+    {
+        sorted[i] = table.ratings[i];
+    }
+    qsort(sorted, CHECK_PLAYERS, sizeof(f32), check_descending_);
+
+    copied uint32_t failed = 0;
+    copied uint32_t ks[]   = { 1, 2, 10, 1000, 54321, CHECK_PLAYERS, CHECK_PLAYERS + 5 };
+    for (uint32_t q = 0; q < sizeof(ks) / sizeof(ks[0]); q++)
+    {
+        copied uint32_t want = (ks[q] < CHECK_PLAYERS) ? ks[q] : CHECK_PLAYERS;
+        copied uint32_t n    = rating_top(&table, ks[q], slots);
+        if (n != want)
+        {
+            printf("top %u: %u players\n", ks[q], n);
+            failed++;
+            continue;
+        }
+        for (uint32_t i = 0; i < n; i++)
+        {
+            if (table.ratings[slots[i]] != sorted[i])
+            {
+                printf("top %u: rank %u is %.2f, not %.2f\n", ks[q], i + 1, table.ratings[slots[i]], sorted[i]);
+                failed++;
+                break;
+            }
+        }
+    }
+
+    for (uint32_t q = 0; q < CHECK_PERCENTILES; q++)
+    {
+        copied uint32_t slot   = rng_below(&rng, CHECK_PLAYERS);
+        copied uint32_t bucket = check_bucket_(table.ratings[slot]);
+        copied uint32_t below  = 0;
+        for (uint32_t i = 0; i < CHECK_PLAYERS; i++)
+        {
+            below += check_bucket_(table.ratings[i]) < bucket;
+        }
+        copied f32 want = cast(below, f32) / cast(CHECK_PLAYERS, f32);
+        copied f32 got  = rating_percentile(&table, slot);
+        if (got != want)
+        {
+            printf("percentile of slot %u: %f, not %f\n", slot, got, want);
+            failed++;
+            break;
+        }
+    }
+
+    free(slots);
+    free(sorted);
+    free(games);
+    rating_free(&table);
+    printf("rating: %s\n", failed ? "FAIL" : "ok");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,37 @@
+#!/bin/sh
+# A checkpointed sharded run killed midway and run again must end with the tally of an
+# uninterrupted run. The opponent always plays rock, so the tally only depends on the
+# players' generators: any torn or lost progress slot shows up as a different count.
+
+set -eu
+
+RPS=${RPS:-./bin/rps}
+ROUNDS=40000000
+dir=$(mktemp -d /tmp/rps-shard-XXXXXX)
+trap 'rm -rf "$dir"' EXIT
+
+printf '%081d\n' 0 > "$dir/rock.table"
+run() {
+    "$RPS" --table "$dir/rock.table" --simulate $ROUNDS --shards 4 --seed 5 "$@" 2>/dev/null
+}
+
+run | grep -E '^(opponent wins|player wins|draws):' > "$dir/whole"
+
+# not through run(): $! would be a subshell, and the run it started would go on writing
+"$RPS" --table "$dir/rock.table" --simulate $ROUNDS --shards 4 --seed 5 --checkpoint "$dir/checkpoint" > /dev/null 2>&1 &
+pid=$!
+sleep 0.3
+kill -KILL $pid
+wait $pid 2>/dev/null || true
+
+run --checkpoint "$dir/checkpoint" > "$dir/resumed"
+if ! grep -q '^resumed:' "$dir/resumed"; then
+    echo "shard: FAIL (nothing was resumed)"
+    exit 1
+fi
+if ! grep -E '^(opponent wins|player wins|draws):' "$dir/resumed" | cmp -s - "$dir/whole"; then
+    echo "shard: FAIL (resumed tally differs)"
+    diff "$dir/whole" "$dir/resumed" || true
+    exit 1
+fi
+echo "shard: ok ($(grep '^resumed:' "$dir/resumed" | sed 's/^resumed: *//'))"
@@ -0,0 +1,94 @@
+/*
+ * Sessions on many threads feeding the sketch while others query it, then a check of
+ * what it learnt. The players all alternate rock and paper: after a rock the sketch must
+ * predict paper, and with no context at all (order 0) scissors must be all but unseen.
+ * `make check` builds this with -fsanitize=thread and with -fsanitize=address.
+ */
+
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "sketch.h"
+
+#define STRESS_WRITERS      (SKETCH_STRIPES + 2)    /* some stripes are shared */
+#define STRESS_READERS      (2)
+#define STRESS_ROUNDS       (200 * 1000)
+#define STRESS_CONFIDENT    (16)
+
+static _Atomic uint32_t _writing = STRESS_WRITERS;
+
+static void * stress_writer_(borrowed void * context)
+{
+    (void) context;
+    copied sketch_context_t player;
+    sketch_context_init(&player);
+    for (uint32_t i = 0; i < STRESS_ROUNDS; i++)
+    {
+        sketch_observe(&player, (i & 1) ? move_paper : move_rock);
+    }
+    atomic_fetch_sub(&_writing, 1);
+    return nil;
+}
+
+static void * stress_reader_(borrowed void * context)
+{
+    (void) context;
+    copied sketch_context_t player;
+    sketch_context_init(&player);
+    sketch_context_push(&player, move_rock);
+
+    copied uint64_t counts[3];
+    while (atomic_load(&_writing) > 0)
+    {
+        sketch_predict(&player, STRESS_CONFIDENT, counts);
+    }
+    return nil;
+}
+
+int main(void)
+{
+    copied uint32_t         failed = 0;
+    copied uint64_t         counts[3];
+    copied sketch_context_t empty;
+    sketch_context_init(&empty);
+
+    /* before anything was observed there is nothing to read, and reading allocates nothing */
+    if (sketch_predict(&empty, 0, counts) != -1)
+    {
+        printf("a fresh sketch predicts\n");
+        failed++;
+    }
+
+    copied pthread_t threads[STRESS_WRITERS + STRESS_READERS];
+    for (uint32_t i = 0; i < STRESS_WRITERS + STRESS_READERS; i++)
+    {
+        pthread_create(&threads[i], nil, (i < STRESS_WRITERS) ? stress_writer_ : stress_reader_, nil);
+    }
+    for (uint32_t i = 0; i < STRESS_WRITERS + STRESS_READERS; i++)
+    {
+        pthread_join(threads[i], nil);
+    }
+
+    copied sketch_context_t rock;
+    sketch_context_init(&rock);
+    sketch_context_push(&rock, move_rock);
+    copied int32_t order = sketch_predict(&rock, STRESS_CONFIDENT, counts);
+    if (order != 1 || counts[move_paper] <= counts[move_rock] || counts[move_paper] <= counts[move_scissors])
+    {
+        printf("after rock: order %d, counts %llu %llu %llu\n", order,
+               cast(counts[0], unsigned long long), cast(counts[1], unsigned long long), cast(counts[2], unsigned long long));
+        failed++;
+    }
+
+    order = sketch_predict(&empty, STRESS_CONFIDENT, counts);
+    if (order != 0 || counts[move_scissors] * 10 > counts[move_rock] || counts[move_scissors] * 10 > counts[move_paper])
+    {
+        printf("no context: order %d, counts %llu %llu %llu\n", order,
+               cast(counts[0], unsigned long long), cast(counts[1], unsigned long long), cast(counts[2], unsigned long long));
+        failed++;
+    }
+
+    printf("sketch: %s\n", failed ? "FAIL" : "ok");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+/*
+ * Readers in tight tuning_lock() / tuning_unlock() sections while the watched file is
+ * rewritten over and over. Each file's fields derive from one number, so a reader seeing
+ * them disagree saw a half-written tuning; a freed one is for the sanitizers to catch
+ * (`make check` builds this with -fsanitize=thread and with -fsanitize=address).
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tuning.h"
+
+#define STRESS_READERS  (4)
+#define STRESS_WRITES   (200)
+#define STRESS_PAUSE_NS (2 * 1000 * 1000)
+
+static _Atomic bool     _done;
+static _Atomic uint32_t _torn;
+
+static void stress_nap_(copied long ns)
+{
+    copied struct timespec pause = { .tv_sec = 0, .tv_nsec = ns };
+    nanosleep(&pause, nil);
+}
+
+static void * stress_reader_(borrowed void * context)
+{
+    (void) context;
+    copied uint64_t last  = 0;
+    copied uint64_t count = 0;
+    while (!atomic_load(&_done))
+    {
+        borrowed const tuning_t * tuning = tuning_lock();
+        copied bool whole = tuning->generation == 0
+                         || (fabsf(2.0f * tuning->exploration - tuning->target_win_rate) < 1e-6f
+                          && fabsf(4.0f * tuning->decay - tuning->target_win_rate) < 1e-6f);
+        if (!whole || tuning->generation < last)
+        {
+            atomic_fetch_add(&_torn, 1);
+        }
+        last = tuning->generation;
+
+        /* now and then hold the section across a reload, so the writer has to wait for it */
+        if (++count % 4096 == 0)
+        {
+            stress_nap_(STRESS_PAUSE_NS);
+        }
+        tuning_unlock();
+    }
+    return nil;
+}
+
+static copied bool stress_write_(borrowed const char * path, borrowed const char * temp, copied uint32_t k)
+{
+    borrowed FILE * file = fopen(temp, "w");
+    if (!file)
+    {
+        return false;
+    }
+    fprintf(file, "target_win_rate = %.6f\nexploration = %.6f\ndecay = %.6f\n", k / 1000.0, k / 2000.0, k / 4000.0);
+    fclose(file);
+    return 0 == rename(temp, path);
+}
+
+int main(void)
+{
+    copied char dir[] = "/tmp/rps-tuning-XXXXXX";
+    if (!mkdtemp(dir))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+    copied char path[64], temp[64];
+    snprintf(path, sizeof(path), "%s/tuning", dir);
+    snprintf(temp, sizeof(temp), "%s/tuning.new", dir);
+
+    copied pthread_t readers[STRESS_READERS];
+    for (uint32_t i = 0; i < STRESS_READERS; i++)
+    {
+        pthread_create(&readers[i], nil, stress_reader_, nil);
+    }
+
+    copied bool ok = stress_write_(path, temp, 1) && tuning_watch(path);
+    for (uint32_t k = 2; ok && k <= STRESS_WRITES; k++)
+    {
+        stress_nap_(STRESS_PAUSE_NS);
+        ok = stress_write_(path, temp, k);
+    }
+    stress_nap_(50 * STRESS_PAUSE_NS);
+
+    atomic_store(&_done, true);
+    for (uint32_t i = 0; i < STRESS_READERS; i++)
+    {
+        pthread_join(readers[i], nil);
+    }
+
+    borrowed const tuning_t * tuning = tuning_lock();
+    copied uint64_t generation = tuning->generation;
+    tuning_unlock();
+
+    unlink(path);
+    rmdir(dir);
+
+    copied bool passed = ok && atomic_load(&_torn) == 0 && generation > 1;
+    printf("tuning: %s (%llu reloads, %u torn reads)\n", passed ? "ok" : "FAIL",
+           cast(generation, unsigned long long), atomic_load(&_torn));
+    return passed ? 0 : 1;
+}